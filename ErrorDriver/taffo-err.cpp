@@ -0,0 +1,312 @@
+//===-- taffo-err.cpp - Batch Error Propagator Driver -----------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// Batch driver for the error propagator.
+/// Each input file is canonicalized and analyzed in a separate process,
+/// with a bounded number of processes running at the same time,
+/// and the outcome for each input is written as a JSON file.
+///
+//===----------------------------------------------------------------------===//
+
+#include <chrono>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+#include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/Config/llvm-config.h"
+#include "llvm/IR/LegacyPassManager.h"
+#include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/Module.h"
+#include "llvm/IRReader/IRReader.h"
+#include "llvm/InitializePasses.h"
+#include "llvm/PassRegistry.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/FormatVariadic.h"
+#include "llvm/Support/InitLLVM.h"
+#include "llvm/Support/JSON.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/SourceMgr.h"
+#include "llvm/Support/Threading.h"
+#include "llvm/Support/raw_ostream.h"
+#include "llvm/Transforms/Scalar.h"
+#include "llvm/Transforms/Utils.h"
+
+#ifdef LLVM_ON_UNIX
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+#include "ErrorPropagator.h"
+#include "ErrorReport.h"
+
+using namespace llvm;
+using namespace ErrorProp;
+
+static cl::list<std::string>
+InputFilenames(cl::Positional, cl::desc("<input files>"), cl::OneOrMore);
+
+static cl::opt<unsigned>
+Jobs("j", cl::desc("Number of inputs processed in parallel "
+		   "(0: one per hardware thread, default: 1)"),
+     cl::value_desc("jobs"), cl::init(1U));
+
+static cl::opt<std::string>
+OutputDir("outdir", cl::desc("Write results, logs and modules to <dir> "
+			     "(default: current directory)"),
+	  cl::value_desc("dir"), cl::init("."));
+
+static cl::opt<bool>
+EmitIR("emitir", cl::desc("Write the annotated module of each input "
+			  "to <dir>/<name>.errprop.ll"),
+       cl::init(false));
+
+static cl::opt<bool>
+NoCanon("nocanon", cl::desc("Do not run mem2reg, simplifycfg, loop-simplify, "
+			    "loop-rotate, lcssa and indvars before the analysis"),
+	cl::init(false));
+
+namespace {
+
+/// An input file, and the name of its outputs in OutputDir.
+struct Job {
+  std::string Input;
+  std::string Name;
+
+  std::string getPath(StringRef Ext) const {
+    SmallString<128> Path(OutputDir);
+    sys::path::append(Path, Name + Ext.str());
+    return Path.str().str();
+  }
+};
+
+/// Give each input a distinct name from its file name.
+std::vector<Job> makeJobs() {
+  std::vector<Job> Res;
+  StringMap<unsigned> Seen;
+  for (const std::string &Input : InputFilenames) {
+    std::string Name = sys::path::stem(Input).str();
+    unsigned Count = Seen[Name]++;
+    if (Count > 0U)
+      Name += "-" + std::to_string(Count);
+    Res.push_back({Input, Name});
+  }
+  return Res;
+}
+
+bool writeResult(const Job &J, json::Object Result) {
+  Result["input"] = J.Input;
+  Result["log"] = J.getPath(".log");
+
+  std::error_code EC;
+  raw_fd_ostream OS(J.getPath(".json"), EC, sys::fs::OF_Text);
+  if (EC) {
+    errs() << "taffo-err: cannot write result for " << J.Input << ": "
+	   << EC.message() << "\n";
+    return false;
+  }
+  OS << formatv("{0:2}", json::Value(std::move(Result))) << "\n";
+  return true;
+}
+
+double secondsSince(std::chrono::steady_clock::time_point Start) {
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - Start)
+    .count();
+}
+
+/// Analyze one input, and write its result.
+/// Returns true if the analysis completed.
+bool processJob(const Job &J) {
+  auto Start = std::chrono::steady_clock::now();
+  json::Object Result;
+
+  LLVMContext Context;
+  SMDiagnostic Err;
+  std::unique_ptr<Module> M = parseIRFile(J.Input, Err, Context);
+  if (M == nullptr) {
+    std::string Msg;
+    raw_string_ostream MsgOS(Msg);
+    Err.print("taffo-err", MsgOS);
+    errs() << MsgOS.str();
+    Result["status"] = "error";
+    Result["message"] = Err.getMessage().str();
+    Result["seconds"] = secondsSince(Start);
+    writeResult(J, std::move(Result));
+    return false;
+  }
+
+  // Canonicalization prescribed for loop unrolling (see README.md).
+  legacy::PassManager PM;
+  if (!NoCanon) {
+    PM.add(createPromoteMemoryToRegisterPass());
+    PM.add(createCFGSimplificationPass());
+    PM.add(createLoopSimplifyPass());
+    PM.add(createLoopRotatePass());
+    PM.add(createLCSSAPass());
+    PM.add(createIndVarSimplifyPass());
+  }
+  ErrorPropagator *EP = new ErrorPropagator();
+  PM.add(EP);
+  PM.run(*M);
+
+  json::Object Targets;
+  for (const auto &T : EP->getTargetErrors())
+    Targets[T.first.str()] = errorToJSON(static_cast<double>(T.second));
+
+  bool Ok = true;
+  Result["targets"] = std::move(Targets);
+
+  if (EmitIR) {
+    std::string OutPath = J.getPath(".errprop.ll");
+    std::error_code EC;
+    raw_fd_ostream OS(OutPath, EC, sys::fs::OF_Text);
+    if (EC) {
+      errs() << "taffo-err: cannot write " << OutPath << ": "
+	     << EC.message() << "\n";
+      Result["message"] = EC.message();
+      Ok = false;
+    } else {
+      M->print(OS, nullptr);
+      Result["output"] = OutPath;
+    }
+  }
+
+  Result["status"] = Ok ? "ok" : "error";
+  Result["seconds"] = secondsSince(Start);
+  return writeResult(J, std::move(Result)) && Ok;
+}
+
+#ifdef LLVM_ON_UNIX
+
+/// Run processJob in a child process, with stderr redirected to the log.
+/// Returns the pid of the child, or -1 if it could not be started.
+pid_t startJob(const Job &J) {
+  outs().flush();
+  errs().flush();
+  pid_t Pid = fork();
+  if (Pid != 0)
+    return Pid;
+
+  int Log = open(J.getPath(".log").c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if (Log >= 0) {
+    dup2(Log, STDERR_FILENO);
+    close(Log);
+  }
+  bool Ok = processJob(J);
+  errs().flush();
+  _exit(Ok ? 0 : 1);
+}
+
+/// Process all jobs, running at most NumJobs of them at a time.
+/// Jobs whose process is killed by a signal are reported as crashed.
+unsigned runJobs(ArrayRef<Job> AllJobs, unsigned NumJobs) {
+  typedef std::pair<unsigned, std::chrono::steady_clock::time_point> RunningJob;
+  std::map<pid_t, RunningJob> Running;
+  unsigned Next = 0U;
+  unsigned Failed = 0U;
+  while (Next < AllJobs.size() || !Running.empty()) {
+    while (Running.size() < NumJobs && Next < AllJobs.size()) {
+      pid_t Pid = startJob(AllJobs[Next]);
+      if (Pid < 0) {
+	errs() << "taffo-err: cannot start process for "
+	       << AllJobs[Next].Input << "\n";
+	json::Object Result;
+	Result["status"] = "error";
+	Result["message"] = "cannot start process";
+	writeResult(AllJobs[Next], std::move(Result));
+	++Failed;
+      } else {
+	Running[Pid] = std::make_pair(Next, std::chrono::steady_clock::now());
+      }
+      ++Next;
+    }
+    if (Running.empty())
+      continue;
+
+    int Status;
+    pid_t Pid = waitpid(-1, &Status, 0);
+    if (Pid < 0 && errno != EINTR) {
+      errs() << "taffo-err: lost track of " << Running.size() << " processes\n";
+      Failed += Running.size();
+      break;
+    }
+    auto It = Running.find(Pid);
+    if (It == Running.end())
+      continue;
+
+    const Job &J = AllJobs[It->second.first];
+    if (WIFSIGNALED(Status)) {
+      json::Object Result;
+      Result["status"] = "crashed";
+      Result["signal"] = WTERMSIG(Status);
+      Result["seconds"] = secondsSince(It->second.second);
+      writeResult(J, std::move(Result));
+      outs() << J.Input << ": crashed\n";
+      ++Failed;
+    } else if (WEXITSTATUS(Status) != 0) {
+      outs() << J.Input << ": error\n";
+      ++Failed;
+    } else {
+      outs() << J.Input << ": ok\n";
+    }
+    Running.erase(It);
+  }
+  return Failed;
+}
+
+#else
+
+unsigned runJobs(ArrayRef<Job> AllJobs, unsigned NumJobs) {
+  unsigned Failed = 0U;
+  for (const Job &J : AllJobs) {
+    bool Ok = processJob(J);
+    outs() << J.Input << (Ok ? ": ok\n" : ": error\n");
+    if (!Ok)
+      ++Failed;
+  }
+  return Failed;
+}
+
+#endif // LLVM_ON_UNIX
+
+} // end of anonymous namespace
+
+int main(int argc, char **argv) {
+  InitLLVM X(argc, argv);
+
+  PassRegistry &Registry = *PassRegistry::getPassRegistry();
+  initializeCore(Registry);
+  initializeAnalysis(Registry);
+  initializeScalarOpts(Registry);
+  initializeTransformUtils(Registry);
+  initializeInstrumentation(Registry);
+
+  cl::ParseCommandLineOptions(argc, argv, "TAFFO error propagator (batch)\n");
+
+  if (std::error_code EC = sys::fs::create_directories(OutputDir)) {
+    errs() << "taffo-err: cannot create " << OutputDir << ": "
+	   << EC.message() << "\n";
+    return 1;
+  }
+
+  unsigned NumJobs = (Jobs == 0U) ? heavyweight_hardware_concurrency() : Jobs;
+  std::vector<Job> AllJobs = makeJobs();
+  unsigned Failed = runJobs(AllJobs, NumJobs);
+
+  outs().flush();
+  if (Failed > 0U)
+    errs() << "taffo-err: " << Failed << " of " << AllJobs.size()
+	   << " inputs failed.\n";
+  return (Failed > 0U) ? 1 : 0;
+}
@@ -0,0 +1,238 @@
+//===-- taffo-errprop.cpp - Error Propagator Driver -------------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// Standalone driver for the error propagator.
+/// Bitcode is loaded lazily, and only the bodies of the starting-point
+/// functions and of the functions they may call are materialized.
+///
+//===----------------------------------------------------------------------===//
+
+#include <memory>
+#include <vector>
+#include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/Bitcode/BitcodeWriter.h"
+#include "llvm/IR/CallSite.h"
+#include "llvm/IR/InstIterator.h"
+#include "llvm/IR/LegacyPassManager.h"
+#include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/Module.h"
+#include "llvm/IRReader/IRReader.h"
+#include "llvm/InitializePasses.h"
+#include "llvm/PassRegistry.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/Debug.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/InitLLVM.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/SourceMgr.h"
+#include "llvm/Support/ToolOutputFile.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include "ErrorPropagator.h"
+#include "ErrorSummary.h"
+#include "Metadata.h"
+
+using namespace llvm;
+using namespace ErrorProp;
+
+#define DEBUG_TYPE "errorprop"
+
+namespace ErrorProp {
+extern cl::list<std::string> SummaryFiles;
+}
+
+static cl::opt<std::string>
+InputFilename(cl::Positional, cl::desc("<input bitcode>"), cl::init("-"));
+
+static cl::opt<std::string>
+OutputFilename("o", cl::desc("Write the module with error metadata to <filename>"),
+	       cl::value_desc("filename"), cl::init(""));
+
+static cl::opt<bool>
+OutputAssembly("S", cl::desc("Write output as LLVM assembly"), cl::init(false));
+
+static cl::opt<bool>
+AnalyzedOnly("analyzedonly",
+	     cl::desc("Write only the bodies of the analyzed functions to the output, "
+		      "as declarations the others (the output cannot replace the input)"),
+	     cl::init(false));
+
+static cl::list<std::string>
+StartFunctions("startfn",
+	       cl::desc("Propagate errors starting from these functions "
+			"(default: functions with start metadata, which are found "
+			"by parsing every function body once more)"),
+	       cl::value_desc("name"), cl::CommaSeparated);
+
+namespace {
+
+bool materialize(Function &F) {
+  if (!F.isMaterializable())
+    return true;
+
+  if (Error Err = F.materialize()) {
+    errs() << "taffo-errprop: cannot load " << F.getName() << ": "
+	   << toString(std::move(Err)) << "\n";
+    return false;
+  }
+  return true;
+}
+
+/// Collect the starting points of M, materializing them.
+/// Without -startfn, functions with start metadata are looked for
+/// in a separate copy of the module, whose function bodies are loaded
+/// and dropped one at a time, so that M only contains what is analyzed.
+bool findRoots(Module &M, MemoryBufferRef Buf, std::vector<Function *> &Roots) {
+  std::vector<std::string> Names(StartFunctions.begin(), StartFunctions.end());
+  if (Names.empty()) {
+    LLVMContext ScanContext;
+    SMDiagnostic Err;
+    std::unique_ptr<Module> Scan =
+      getLazyIRModule(MemoryBuffer::getMemBuffer(Buf, false), Err, ScanContext);
+    if (Scan == nullptr) {
+      Err.print("taffo-errprop", errs());
+      return false;
+    }
+    for (Function &F : *Scan) {
+      bool WasMaterializable = F.isMaterializable();
+      if (!materialize(F))
+	return false;
+      if (!F.empty() && mdutils::MetadataManager::isStartingPoint(F))
+	Names.push_back(F.getName().str());
+      if (WasMaterializable)
+	F.deleteBody();
+    }
+  }
+
+  for (const std::string &Name : Names) {
+    Function *F = M.getFunction(Name);
+    if (F == nullptr || !materialize(*F) || F->empty()) {
+      errs() << "taffo-errprop: no body for start function " << Name << "\n";
+      return false;
+    }
+    Roots.push_back(F);
+  }
+  return true;
+}
+
+/// Materialize all functions that may be called from Roots.
+/// Callees with a summary are left unmaterialized: the pass loads them
+/// only if the summary does not cover the arguments of a call.
+bool materializeCallees(ArrayRef<Function *> Roots,
+			const ErrorSummaryDB &Summaries) {
+  SmallPtrSet<Function *, 16U> Visited(Roots.begin(), Roots.end());
+  std::vector<Function *> Worklist(Roots.begin(), Roots.end());
+  while (!Worklist.empty()) {
+    Function *F = Worklist.back();
+    Worklist.pop_back();
+    for (Instruction &I : instructions(*F)) {
+      CallSite CS(&I);
+      if (!CS)
+	continue;
+
+      Function *Callee = dyn_cast<Function>(CS.getCalledValue()->stripPointerCasts());
+      if (Callee == nullptr || !Visited.insert(Callee).second
+	  || Summaries.lookup(Callee->getName()) != nullptr)
+	continue;
+
+      if (!materialize(*Callee))
+	return false;
+      if (!Callee->empty())
+	Worklist.push_back(Callee);
+    }
+  }
+
+  LLVM_DEBUG(dbgs() << "[taffo-err] Materialized " << Visited.size()
+	     << " functions.\n");
+  return true;
+}
+
+} // end of anonymous namespace
+
+int main(int argc, char **argv) {
+  InitLLVM X(argc, argv);
+
+  PassRegistry &Registry = *PassRegistry::getPassRegistry();
+  initializeCore(Registry);
+  initializeAnalysis(Registry);
+  initializeTransformUtils(Registry);
+  initializeInstrumentation(Registry);
+
+  cl::ParseCommandLineOptions(argc, argv, "TAFFO error propagator\n");
+
+  ErrorOr<std::unique_ptr<MemoryBuffer>> Buf =
+    MemoryBuffer::getFileOrSTDIN(InputFilename);
+  if (!Buf) {
+    errs() << "taffo-errprop: cannot read " << InputFilename << ": "
+	   << Buf.getError().message() << "\n";
+    return 1;
+  }
+
+  LLVMContext Context;
+  SMDiagnostic Err;
+  std::unique_ptr<Module> M =
+    getLazyIRModule(MemoryBuffer::getMemBuffer((*Buf)->getMemBufferRef(), false),
+		    Err, Context);
+  if (M == nullptr) {
+    Err.print(argv[0], errs());
+    return 1;
+  }
+
+  std::vector<Function *> Roots;
+  if (!findRoots(*M, (*Buf)->getMemBufferRef(), Roots))
+    return 1;
+  if (Roots.empty()) {
+    errs() << "taffo-errprop: no starting-point functions found, "
+	   << "use -startfn to choose them.\n";
+    return 1;
+  }
+
+  // The pass reads the same files again; here they only avoid loading callees.
+  ErrorSummaryDB Summaries;
+  for (const std::string &File : SummaryFiles)
+    Summaries.readFile(File);
+  if (!materializeCallees(Roots, Summaries))
+    return 1;
+
+  legacy::PassManager PM;
+  PM.add(createErrorPropagatorPass(Roots));
+  PM.run(*M);
+
+  if (OutputFilename.empty())
+    return 0;
+
+  std::error_code EC;
+  ToolOutputFile Out(OutputFilename, EC,
+		     OutputAssembly ? sys::fs::OF_Text : sys::fs::OF_None);
+  if (EC) {
+    errs() << "taffo-errprop: " << EC.message() << "\n";
+    return 1;
+  }
+
+  // The output is a complete module, unless only the analyzed functions
+  // are requested: then the bodies that were not loaded need not be loaded now.
+  if (AnalyzedOnly)
+    for (Function &F : *M)
+      if (F.isMaterializable()) {
+	F.deleteBody();
+	F.setComdat(nullptr);
+      }
+  if (Error E = M->materializeAll()) {
+    errs() << "taffo-errprop: " << toString(std::move(E)) << "\n";
+    return 1;
+  }
+  if (OutputAssembly)
+    M->print(Out.os(), nullptr);
+  else
+    WriteBitcodeToFile(*M, Out.os());
+  Out.keep();
+
+  return 0;
+}
@@ -64,6 +64,11 @@ public:
     return this->Symbol < Other.Symbol;
   }
 
+  /// The symbol that will be given to the next new noise term.
+  static SymbolT getNextSymId() {
+    return SymId;
+  }
+
 protected:
 
   /// Construct a NoiseTerm with a new unique symbolic value.
@@ -203,6 +208,16 @@ public:
     this->X0 = NX0;
   }
 
+  size_t getNumNoiseTerms() const {
+    return this->Xi.size();
+  }
+
+  /// Bytes held by this form, including noise terms stored out of line.
+  size_t getMemoryUsage() const {
+    return sizeof(*this)
+      + ((Xi.capacity() > DEFAULT_NOISE_SIZE) ? Xi.capacity_in_bytes() : 0U);
+  }
+
   T noiseTermsAbsSum() const {
     T Rad = 0;
     for (const NoiseTerm<T> &NT : Xi) {
@@ -0,0 +1,51 @@
+//===-- AnalysisContext.h - Shared Analyses and Outputs ---------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// The optional analyses and outputs shared by the analyses
+/// of all functions of a module.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef ERRORPROPAGATOR_ANALYSISCONTEXT_H
+#define ERRORPROPAGATOR_ANALYSISCONTEXT_H
+
+#include "TargetSlice.h"
+#include "PointsTo.h"
+#include "ErrorSummary.h"
+#include "ErrorReport.h"
+#include "ErrorMetadataEmitter.h"
+#include "FunctionProfiler.h"
+#include "ErrorTelemetry.h"
+
+namespace ErrorProp {
+
+/// Optional analyses and outputs of a run of the error propagator.
+/// Null members are disabled.
+struct AnalysisContext {
+  /// Restrict the analysis, cloning and unrolling
+  /// to the instructions, functions and loops in the slice.
+  const TargetSlice *Slice = nullptr;
+  /// Points-to data, kept up to date with function copies.
+  PointsToAnalysis *PTA = nullptr;
+  /// Summaries used instead of analyzing the functions they cover.
+  const ErrorSummaryDB *Summaries = nullptr;
+  /// Records the errors attached as metadata.
+  ErrorReport *Report = nullptr;
+  /// Attaches error metadata, instead of attaching it to all instructions.
+  ErrorMetadataEmitter *MDEmitter = nullptr;
+  /// Records the cost of each function analysis.
+  FunctionProfiler *Profiler = nullptr;
+  /// Records noise term counts and memory usage.
+  ErrorTelemetry *Telemetry = nullptr;
+};
+
+} // end namespace ErrorProp
+
+#endif
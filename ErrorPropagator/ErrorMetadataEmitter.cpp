@@ -0,0 +1,134 @@
+//===-- ErrorMetadataEmitter.cpp - Error Metadata Emission ------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// Selects the instructions that get error metadata,
+/// and rounds errors so that equal values share the same metadata node.
+///
+//===----------------------------------------------------------------------===//
+
+#include "ErrorMetadataEmitter.h"
+
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include "llvm/Bitcode/BitcodeWriter.h"
+#include "Metadata.h"
+
+namespace ErrorProp {
+
+using namespace llvm;
+using namespace mdutils;
+
+namespace {
+
+/// Stream that only counts the bytes written to it.
+class CountingOStream : public raw_ostream {
+public:
+  CountingOStream() : Size(0U) { SetUnbuffered(); }
+
+private:
+  uint64_t Size;
+
+  void write_impl(const char *, size_t S) override { Size += S; }
+  uint64_t current_pos() const override { return Size; }
+};
+
+} // end of anonymous namespace
+
+void ErrorMetadataEmitter::beginFunction(Function &F) {
+  if (Mode != ErrorMDMode::LoopExits || CurrentF == &F)
+    return;
+
+  CurrentF = &F;
+  DT.reset(new DominatorTree(F));
+  LI.reset(new LoopInfo(*DT));
+}
+
+bool ErrorMetadataEmitter::isSelected(const Instruction &I) const {
+  switch (Mode) {
+  case ErrorMDMode::All:
+    return true;
+  case ErrorMDMode::Targets:
+    return MetadataManager::retrieveTargetMetadata(I).hasValue();
+  case ErrorMDMode::LoopExits: {
+    assert(CurrentF == I.getFunction() && "beginFunction not called.");
+    const Loop *L = LI->getLoopFor(I.getParent());
+    if (L == nullptr)
+      return false;
+    for (const User *U : I.users())
+      if (!L->contains(cast<Instruction>(U)))
+	return true;
+    return false;
+  }
+  case ErrorMDMode::None:
+    return false;
+  }
+  llvm_unreachable("Unknown error metadata mode.");
+}
+
+bool ErrorMetadataEmitter::emitError(Instruction &I, double Error) {
+  if (Error < Threshold || !isSelected(I)) {
+    ++NumOmitted;
+    return false;
+  }
+
+  double QError = quantize(Error, Digits);
+  // MDNodes are uniqued, so instructions with the same value share one node.
+  MetadataManager::setErrorMetadata(I, QError);
+
+  uint64_t Bits;
+  std::memcpy(&Bits, &QError, sizeof(Bits));
+  Values.insert(Bits);
+  ++NumEmitted;
+  return true;
+}
+
+double ErrorMetadataEmitter::quantize(double Error, unsigned Digits) {
+  if (Digits == 0U || Error <= 0.0 || !std::isfinite(Error))
+    return Error;
+
+  // Round up, so that the emitted error is still an upper bound.
+  int Exp = static_cast<int>(std::floor(std::log10(Error)));
+  double Scale = std::pow(10.0, static_cast<int>(Digits) - 1 - Exp);
+  if (!std::isfinite(Scale))
+    return Error;
+  double QError = std::ceil(Error * Scale) / Scale;
+  if (QError < Error)
+    QError = std::nextafter(QError, std::numeric_limits<double>::infinity());
+  return QError;
+}
+
+void ErrorMetadataEmitter::endFunction() {
+  CurrentF = nullptr;
+  LI.reset();
+  DT.reset();
+}
+
+uint64_t ErrorMetadataEmitter::getBitcodeSize(const Module &M) {
+  assert(M.isMaterialized() && "Cannot write a partially loaded module.");
+  CountingOStream OS;
+  WriteBitcodeToFile(M, OS);
+  return OS.tell();
+}
+
+void ErrorMetadataEmitter::printStats(raw_ostream &OS) const {
+  OS << "Error metadata attached to " << NumEmitted << " instructions ("
+     << Values.size() << " distinct values), omitted for " << NumOmitted
+     << " instructions.\n";
+}
+
+void ErrorMetadataEmitter::printSizes(raw_ostream &OS) const {
+  if (SizeBefore != 0U && SizeAfter != 0U)
+    OS << "Bitcode size: " << SizeBefore << " bytes before, "
+       << SizeAfter << " bytes after error metadata ("
+       << static_cast<int64_t>(SizeAfter - SizeBefore) << " bytes).\n";
+}
+
+} // end of namespace ErrorProp
@@ -0,0 +1,97 @@
+//===-- ErrorMetadataEmitter.h - Error Metadata Emission --------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// Selects the instructions that get error metadata,
+/// and rounds errors so that equal values share the same metadata node.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef ERRORPROPAGATOR_ERROR_METADATA_EMITTER_H
+#define ERRORPROPAGATOR_ERROR_METADATA_EMITTER_H
+
+#include <cstdint>
+#include <memory>
+#include "llvm/ADT/DenseSet.h"
+#include "llvm/Analysis/LoopInfo.h"
+#include "llvm/IR/Dominators.h"
+#include "llvm/IR/Function.h"
+#include "llvm/IR/Instruction.h"
+#include "llvm/IR/Module.h"
+#include "llvm/Support/raw_ostream.h"
+
+namespace ErrorProp {
+
+/// Instructions that get error metadata.
+enum class ErrorMDMode {
+  All,       ///< All instructions with an error.
+  Targets,   ///< Only instructions marked as targets.
+  LoopExits, ///< Only instructions in loops used outside of them.
+  None       ///< No instruction.
+};
+
+class ErrorMetadataEmitter {
+public:
+  /// Errors are rounded up to Digits significant digits (if not 0),
+  /// and errors smaller than Threshold are not emitted.
+  ErrorMetadataEmitter(ErrorMDMode Mode = ErrorMDMode::All,
+		       unsigned Digits = 0U, double Threshold = 0.0)
+    : Mode(Mode), Digits(Digits), Threshold(Threshold),
+      NumEmitted(0U), NumOmitted(0U) {}
+
+  /// Must be called before emitting errors for the instructions of F.
+  void beginFunction(llvm::Function &F);
+
+  /// Drop the analyses of the current function,
+  /// which may be deleted or modified afterwards.
+  void endFunction();
+
+  /// Attach Error to I as metadata, if I is selected by the mode
+  /// and Error is above the threshold. Returns true if it was attached.
+  bool emitError(llvm::Instruction &I, double Error);
+
+  /// Error rounded up to Digits significant digits.
+  static double quantize(double Error, unsigned Digits);
+
+  /// Record the size of M in bitcode before and after emission.
+  /// M must be fully materialized.
+  void measureModuleBefore(const llvm::Module &M) { SizeBefore = getBitcodeSize(M); }
+  void measureModuleAfter(const llvm::Module &M) { SizeAfter = getBitcodeSize(M); }
+
+  /// Number of bytes of the bitcode of M.
+  static uint64_t getBitcodeSize(const llvm::Module &M);
+
+  /// Print the number of annotated instructions and distinct values.
+  void printStats(llvm::raw_ostream &OS) const;
+
+  /// Print the bitcode sizes, if measured.
+  void printSizes(llvm::raw_ostream &OS) const;
+
+private:
+  ErrorMDMode Mode;
+  unsigned Digits;
+  double Threshold;
+
+  llvm::Function *CurrentF = nullptr;
+  std::unique_ptr<llvm::DominatorTree> DT;
+  std::unique_ptr<llvm::LoopInfo> LI;
+
+  unsigned NumEmitted;
+  unsigned NumOmitted;
+  uint64_t SizeBefore = 0U;
+  uint64_t SizeAfter = 0U;
+  /// Bit patterns of the distinct emitted values.
+  llvm::DenseSet<uint64_t> Values;
+
+  bool isSelected(const llvm::Instruction &I) const;
+};
+
+} // end of namespace ErrorProp
+
+#endif // ERRORPROPAGATOR_ERROR_METADATA_EMITTER_H
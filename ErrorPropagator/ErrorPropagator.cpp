@@ -14,6 +14,12 @@
 
 #include "ErrorPropagator.h"
 
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <tuple>
+#include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Debug.h"
 #include "llvm/IR/Dominators.h"
 #include "llvm/Analysis/LoopInfo.h"
@@ -21,9 +27,19 @@
 #include "llvm/Analysis/ScalarEvolution.h"
 #include "llvm/Analysis/OptimizationRemarkEmitter.h"
 #include "llvm/Analysis/MemorySSA.h"
+#include "llvm/Analysis/TargetLibraryInfo.h"
 
 #include "Metadata.h"
 #include "FunctionErrorPropagator.h"
+#include "TargetSlice.h"
+#include "PointsTo.h"
+#include "SpecialFunctions.h"
+#include "ErrorSummary.h"
+#include "ErrorReport.h"
+#include "ErrorMetadataEmitter.h"
+#include "PhaseTimer.h"
+#include "FunctionProfiler.h"
+#include "ErrorTelemetry.h"
 
 namespace ErrorProp {
 
@@ -32,7 +48,142 @@ using namespace mdutils;
 
 #define DEBUG_TYPE "errorprop"
 
+llvm::cl::opt<unsigned> DefaultUnrollCount("dunroll",
+					   llvm::cl::desc("Default loop unroll count"),
+					   llvm::cl::value_desc("count"),
+					   llvm::cl::init(1U));
+llvm::cl::opt<unsigned> MaxUnroll("maxunroll",
+                                  llvm::cl::desc("Max loop unroll count. "
+                                                 "Setting this to 0 disables loop unrolling. "
+                                                 "(Default: 256)"),
+                                  llvm::cl::value_desc("count"),
+                                  llvm::cl::init(256U));
+llvm::cl::opt<bool> NoLoopUnroll("nounroll",
+				 llvm::cl::desc("Never unroll loops (legacy, use -max-unroll=0)"),
+				 llvm::cl::init(false));
+llvm::cl::opt<bool> ProfileUnroll("profunroll",
+				  llvm::cl::desc("Use trip counts from branch weight metadata "
+						 "when they cannot be computed. (Default: false)"),
+				  llvm::cl::init(false));
+llvm::cl::opt<unsigned> CloneCacheSize("clonecache",
+				       llvm::cl::desc("Keep up to <kb> KiB of unrolled function copies "
+						      "not in use, to reuse them in later calls "
+						      "(Default: 65536)."),
+				       llvm::cl::value_desc("kb"),
+				       llvm::cl::init(65536U));
+llvm::cl::opt<bool> UnrollAll("unrollall",
+			      llvm::cl::desc("Unroll also loops that cannot affect annotated values or targets."),
+			      llvm::cl::init(false));
+llvm::cl::opt<unsigned> CmpErrorThreshold("cmpthresh",
+					  llvm::cl::desc("CMP errors are signaled"
+							 "only if error is above perc %"),
+					  llvm::cl::value_desc("perc"),
+					  llvm::cl::init(0U));
+llvm::cl::opt<unsigned> MaxRecursionCount("recur",
+					  llvm::cl::desc("Default number of recursive calls"
+							 "to the same function."),
+					  llvm::cl::value_desc("count"),
+					  llvm::cl::init(1U));
+llvm::cl::opt<bool> StartOnly("startonly",
+			      llvm::cl::desc("Propagate only functions with start metadata."),
+			      llvm::cl::init(false));
+llvm::cl::opt<bool> Relative("relerror",
+			      llvm::cl::desc("Output relative errors instead of absolute errors (experimental)."),
+			      llvm::cl::init(false));
+llvm::cl::opt<bool> ExactConst("exactconst",
+			       llvm::cl::desc("Treat all constants as exact."),
+			       llvm::cl::init(false));
+llvm::cl::opt<bool> Sparse("sparse",
+			   llvm::cl::desc("Only process instructions reachable through def-use chains "
+					  "from values with ranges or errors."),
+			   llvm::cl::init(false));
+llvm::cl::opt<bool> TargetOnly("targetonly",
+			       llvm::cl::desc("Only propagate errors to instructions "
+					      "on which target variables depend."),
+			       llvm::cl::init(false));
+llvm::cl::opt<bool> SloppyAA("sloppyaa",
+                             llvm::cl::desc("Enable sloppy Alias Analysis, for when LLVM AA fails. "
+                                            "Loads are resolved with a field-sensitive points-to analysis."),
+                             llvm::cl::init(false));
+llvm::cl::list<std::string> SpecialFunctionAliases("specialfn",
+						   llvm::cl::desc("Treat calls to <name> as calls to the elementary "
+								  "function <fn>, e.g. -specialfn=my_sqrt=sqrt."),
+						   llvm::cl::value_desc("name=fn"),
+						   llvm::cl::CommaSeparated);
+llvm::cl::list<std::string> SummaryFiles("summaries",
+					 llvm::cl::desc("Use the function error summaries in <file> (YAML, "
+							"or modules with embedded summaries) "
+							"instead of analyzing the functions they cover."),
+					 llvm::cl::value_desc("file"),
+					 llvm::cl::CommaSeparated);
+llvm::cl::opt<std::string> EmitSummaries("emitsummaries",
+					 llvm::cl::desc("Write error summaries of the functions with "
+							"range metadata on all arguments to <file>."),
+					 llvm::cl::value_desc("file"),
+					 llvm::cl::init(""));
+llvm::cl::opt<double> SummaryMaxRelError("summaryrelerr",
+					 llvm::cl::desc("Emitted summaries hold for errors on each argument "
+							"up to <err> times its largest magnitude "
+							"(Default: 0.01)."),
+					 llvm::cl::value_desc("err"),
+					 llvm::cl::init(0.01));
+llvm::cl::opt<std::string> ReportFile("errorprop-report",
+				      llvm::cl::desc("Write the computed errors of targets, functions, "
+						     "instructions and comparisons to <file> as JSON Lines."),
+				      llvm::cl::value_desc("file"),
+				      llvm::cl::init(""));
+llvm::cl::opt<bool> EmitTelemetry("errtelemetry",
+				  llvm::cl::desc("Add noise term histograms and peak memory usage "
+						 "to the -errorprop-report file."),
+				  llvm::cl::init(false));
+llvm::cl::opt<ErrorMDMode> ErrorMDEmission("errmd",
+					   llvm::cl::desc("Instructions to which error metadata is attached:"),
+					   llvm::cl::values(clEnumValN(ErrorMDMode::All, "all",
+								       "all instructions (default)"),
+							    clEnumValN(ErrorMDMode::Targets, "targets",
+								       "instructions marked as targets"),
+							    clEnumValN(ErrorMDMode::LoopExits, "exits",
+								       "instructions in loops used outside of them"),
+							    clEnumValN(ErrorMDMode::None, "none",
+								       "no instruction")),
+					   llvm::cl::init(ErrorMDMode::All));
+llvm::cl::opt<unsigned> ErrorMDDigits("errmddigits",
+				      llvm::cl::desc("Round errors in metadata up to <n> significant digits, "
+						     "so that instructions with close errors share nodes "
+						     "(Default: 0, exact)."),
+				      llvm::cl::value_desc("n"),
+				      llvm::cl::init(0U));
+llvm::cl::opt<double> ErrorMDThreshold("errmdthresh",
+				       llvm::cl::desc("Do not attach errors smaller than <err> as metadata."),
+				       llvm::cl::value_desc("err"),
+				       llvm::cl::init(0.0));
+llvm::cl::opt<bool> ErrorMDSize("errmdsize",
+				llvm::cl::desc("Print the bitcode size of the module "
+					       "before and after attaching error metadata."),
+				llvm::cl::init(false));
+llvm::cl::opt<std::string> ProfileFile("errprofile",
+				       llvm::cl::desc("Write the functions that took most time "
+						      "to analyze to <file> (- for stdout)."),
+				       llvm::cl::value_desc("file"),
+				       llvm::cl::init(""));
+llvm::cl::opt<unsigned> ProfileTop("errprofiletop",
+				   llvm::cl::desc("Number of functions in the -errprofile table "
+						  "(Default: 20)."),
+				   llvm::cl::value_desc("n"),
+				   llvm::cl::init(20U));
+llvm::cl::opt<std::string> TraceFile("errtrace",
+				     llvm::cl::desc("Write the timeline of function analyses "
+						    "to <file> in Chrome trace-event format."),
+				     llvm::cl::value_desc("file"),
+				     llvm::cl::init(""));
+llvm::cl::opt<bool> EmbedSummaries("embedsummaries",
+				   llvm::cl::desc("Embed the error summaries of exported functions "
+						  "in the module as named metadata."),
+				   llvm::cl::init(false));
+
 bool ErrorPropagator::runOnModule(Module &M) {
+  // Functions of previously analyzed modules may have been deleted.
+  SpecialFunctionRegistry::get().clearCache();
   checkCommandLine();
 
   MetadataManager &MDManager = MetadataManager::getMetadataManager();
@@ -40,27 +191,81 @@ bool ErrorPropagator::runOnModule(Module &M) {
   RangeErrorMap GlobalRMap(MDManager, !Relative, ExactConst);
 
   // Get Ranges and initial Errors for global variables.
-  retrieveGlobalVariablesRangeError(M, GlobalRMap);
+  {
+    PhaseTimer T("mdretrieve", "Metadata retrieval");
+    retrieveGlobalVariablesRangeError(M, GlobalRMap);
+  }
 
-  // Copy list of original functions, so we don't mess up with copies.
+  // Copy list of the original functions to start from,
+  // so we don't mess up with copies.
+  // Functions whose body is missing (or has not been materialized) are skipped.
   SmallVector<Function *, 4U> Functions;
-  Functions.reserve(M.size());
   for (Function &F : M) {
+    if (F.empty())
+      continue;
+    if (!Roots.empty() ? Roots.count(&F) == 0
+	: StartOnly && !MetadataManager::isStartingPoint(F))
+      continue;
     Functions.push_back(&F);
   }
 
-  FunctionCopyManager FCMap(*this, MaxRecursionCount, DefaultUnrollCount,
-			    MaxUnroll);
+  AnalysisContext Ctx;
+
+  // The points-to analysis must outlive the function copies.
+  std::unique_ptr<PointsToAnalysis> PTA;
+  if (SloppyAA)
+    PTA.reset(new PointsToAnalysis(M));
+  Ctx.PTA = PTA.get();
+
+  FunctionCopyManager FCMap(*this, Ctx, MaxRecursionCount, DefaultUnrollCount,
+			    MaxUnroll, !UnrollAll, ProfileUnroll,
+			    static_cast<size_t>(CloneCacheSize) * 1024U);
+
+  ErrorSummaryDB Summaries;
+  for (const std::string &File : SummaryFiles)
+    Summaries.readFile(File);
+  if (!Summaries.empty())
+    Ctx.Summaries = &Summaries;
+
+  ErrorReport Report;
+  if (!ReportFile.empty())
+    Ctx.Report = &Report;
+
+  ErrorTelemetry Tel;
+  if (EmitTelemetry && !ReportFile.empty()) {
+    Ctx.Telemetry = &Tel;
+    Report.setTelemetry(&Tel);
+  }
+
+  ErrorMetadataEmitter MDEmitter(ErrorMDEmission, ErrorMDDigits, ErrorMDThreshold);
+  Ctx.MDEmitter = &MDEmitter;
+  // Partially loaded modules (cf. taffo-errprop) cannot be written.
+  bool MeasureSize = ErrorMDSize && M.isMaterialized();
+  if (MeasureSize)
+    MDEmitter.measureModuleBefore(M);
+
+  FunctionProfiler Profiler;
+  if (!ProfileFile.empty() || !TraceFile.empty())
+    Ctx.Profiler = &Profiler;
+
+  std::unique_ptr<TargetSlice> Slice;
+  if (TargetOnly) {
+    Slice.reset(new TargetSlice(*this, M));
+    if (Slice->empty())
+      dbgs() << "[taffo-err] WARNING: no target variables found, nothing to propagate.\n";
+    Ctx.Slice = Slice.get();
+  }
 
   bool NoFunctions = true;
   // Iterate over all functions in this Module,
   // and propagate errors for pending input intervals for all of them.
   for (Function *F : Functions) {
-    if (StartOnly && !MetadataManager::isStartingPoint(*F))
+    // Functions that cannot reach the slice get no error metadata.
+    if (Slice && !Slice->reaches(F))
       continue;
 
     NoFunctions = false;
-    FunctionErrorPropagator FEP(*this, *F, FCMap, MDManager, SloppyAA);
+    FunctionErrorPropagator FEP(*this, *F, FCMap, MDManager, Ctx, Sparse);
     FEP.computeErrorsWithCopy(GlobalRMap, nullptr, true);
   }
 
@@ -69,6 +274,30 @@ bool ErrorPropagator::runOnModule(Module &M) {
 
   dbgs() << "\n*** Target Errors: ***\n";
   GlobalRMap.printTargetErrors(dbgs());
+  TErrs = GlobalRMap.getTargetErrors();
+  if (MeasureSize) {
+    MDEmitter.measureModuleAfter(M);
+    MDEmitter.printSizes(dbgs());
+  }
+  LLVM_DEBUG(MDEmitter.printStats(dbgs()));
+  Ctx.MDEmitter = nullptr;
+
+  if (!ReportFile.empty()) {
+    Report.writeFile(ReportFile, M, GlobalRMap);
+    Ctx.Report = nullptr;
+  }
+  Ctx.Telemetry = nullptr;
+
+  if (!ProfileFile.empty())
+    Profiler.writeTableFile(ProfileFile, ProfileTop);
+  if (!TraceFile.empty())
+    Profiler.writeTraceFile(TraceFile);
+  Ctx.Profiler = nullptr;
+
+  if (!EmitSummaries.empty() || EmbedSummaries)
+    emitSummaries(M, GlobalRMap, FCMap, Ctx);
+
+  PhaseTimer::printAll();
 
   return false;
 }
@@ -80,11 +309,107 @@ void ErrorPropagator::retrieveGlobalVariablesRangeError(Module &M,
   }
 }
 
+void ErrorPropagator::emitSummaries(Module &M, const RangeErrorMap &GlobalRMap,
+				    FunctionCopyManager &FCMap, const AnalysisContext &Ctx) {
+  ErrorSummaryDB DB;
+  for (Function &F : M) {
+    ErrorSummary S;
+    if (computeSummary(F, GlobalRMap, FCMap, Ctx, S))
+      DB.addSummary(S);
+  }
+
+  if (!EmitSummaries.empty())
+    DB.writeFile(EmitSummaries);
+  if (EmbedSummaries)
+    DB.writeModuleMetadata(M);
+}
+
+bool ErrorPropagator::computeSummary(Function &F, const RangeErrorMap &GlobalRMap,
+				     FunctionCopyManager &FCMap, const AnalysisContext &Ctx,
+				     ErrorSummary &S) {
+  // Only exported functions of scalars can be summarized:
+  // pointer arguments would need the errors of the pointed memory.
+  if (F.empty() || !F.hasName() || F.hasLocalLinkage() || F.arg_empty()
+      || !(F.getReturnType()->isIntegerTy() || F.getReturnType()->isFloatingPointTy()))
+    return false;
+  for (Argument &Arg : F.args())
+    if (!(Arg.getType()->isIntegerTy() || Arg.getType()->isFloatingPointTy()))
+      return false;
+
+  // The summary is valid for the argument ranges in metadata.
+  MetadataManager &MDManager = MetadataManager::getMetadataManager();
+  SmallVector<MDInfo *, 4U> ArgInfo;
+  MDManager.retrieveArgumentInputInfo(F, ArgInfo);
+  if (ArgInfo.size() != F.arg_size())
+    return false;
+  S.Name = F.getName().str();
+  for (MDInfo *MDI : ArgInfo) {
+    const InputInfo *II = dyn_cast_or_null<InputInfo>(MDI);
+    if (II == nullptr || II->IRange == nullptr)
+      return false;
+    ErrorSummary::ArgRange R;
+    R.Min = II->IRange->Min;
+    R.Max = II->IRange->Max;
+    R.MaxError = SummaryMaxRelError * std::max(std::abs(R.Min), std::abs(R.Max));
+    if (!(R.MaxError > 0.0))
+      R.MaxError = SummaryMaxRelError;
+    S.Args.push_back(R);
+  }
+
+  LLVM_DEBUG(dbgs() << "[taffo-err] Computing summary of " << F.getName() << ".\n");
+
+  // Error on the returned value when argument ArgIdx has error ArgError,
+  // and all other arguments are exact.
+  // Arguments are scalars, so the errors of pointed objects are not needed:
+  // probes run without points-to data.
+  AnalysisContext ProbeCtx(Ctx);
+  ProbeCtx.PTA = nullptr;
+  auto computeReturnError = [&](unsigned ArgIdx, inter_t ArgError) -> inter_t {
+    RangeErrorMap RMap(GlobalRMap);
+    RMap.erase(&F);
+    SmallVector<Value *, 4U> Args;
+    for (Argument &Arg : F.args()) {
+      RMap.setError(&Arg, (Arg.getArgNo() == ArgIdx)
+		    ? AffineForm<inter_t>(0.0, ArgError) : AffineForm<inter_t>(0.0));
+      Args.push_back(&Arg);
+    }
+
+    FunctionErrorPropagator FEP(*this, F, FCMap, MDManager, ProbeCtx, Sparse);
+    FEP.computeErrorsWithCopy(RMap, &Args, false);
+
+    const AffineForm<inter_t> *Err = RMap.getError(&F);
+    return (Err != nullptr) ? Err->noiseTermsAbsSum()
+      : std::numeric_limits<inter_t>::quiet_NaN();
+  };
+
+  // Each sensitivity is the slope of the secant between no error and
+  // the largest error for which the summary holds.
+  // Joins (phi, select, loads) take the maximum of the incoming errors,
+  // so small errors may be hidden by a larger one on another path,
+  // while the secant bounds the error up to MaxError
+  // (errors grow at least linearly with the errors on the arguments).
+  inter_t ExactError = computeReturnError(F.arg_size(), 0.0);
+  if (std::isnan(ExactError))
+    return false;
+  S.Error = ExactError;
+  for (unsigned Idx = 0U; Idx < F.arg_size(); ++Idx) {
+    inter_t ProbeError = S.Args[Idx].MaxError;
+    inter_t ArgError = computeReturnError(Idx, ProbeError);
+    if (std::isnan(ArgError))
+      return false;
+    S.Sensitivity.push_back(std::max(static_cast<inter_t>(0.0),
+				     (ArgError - ExactError) / ProbeError));
+  }
+
+  return true;
+}
+
 void ErrorPropagator::getAnalysisUsage(AnalysisUsage &AU) const {
   AU.addRequiredTransitive<DominatorTreeWrapperPass>();
   AU.addRequiredTransitive<LoopInfoWrapperPass>();
   AU.addRequiredTransitive<AssumptionCacheTracker>();
   AU.addRequiredTransitive<ScalarEvolutionWrapperPass>();
+  AU.addRequiredTransitive<TargetLibraryInfoWrapperPass>();
   AU.addRequiredTransitive<OptimizationRemarkEmitterWrapperPass>();
   AU.addRequiredTransitive<MemorySSAWrapperPass>();
   AU.setPreservesAll();
@@ -96,12 +421,28 @@ void ErrorPropagator::checkCommandLine() {
 
   if (NoLoopUnroll)
     MaxUnroll = 0U;
+
+  if (EmitTelemetry && ReportFile.empty())
+    dbgs() << "[taffo-err] WARNING: -errtelemetry ignored without -errorprop-report.\n";
+
+  for (const std::string &Alias : SpecialFunctionAliases) {
+    StringRef Name, Fn;
+    std::tie(Name, Fn) = StringRef(Alias).split('=');
+    if (Name.empty() || !SpecialFunctionRegistry::get().registerAlias(Name, Fn))
+      dbgs() << "[taffo-err] WARNING: ignoring -specialfn=" << Alias
+	     << " (unknown elementary function).\n";
+  }
 }
 
 }  // end of namespace ErrorProp
 
 char ErrorProp::ErrorPropagator::ID = 0;
 
+llvm::ModulePass *
+ErrorProp::createErrorPropagatorPass(llvm::ArrayRef<llvm::Function *> Roots) {
+  return new ErrorProp::ErrorPropagator(Roots);
+}
+
 static llvm::RegisterPass<ErrorProp::ErrorPropagator>
 X("errorprop", "Fixed-Point Arithmetic Error Propagator",
   false /* Only looks at CFG */,
@@ -0,0 +1,122 @@
+//===-- ErrorReport.cpp - Machine-Readable Error Report ---------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// Collects the errors computed by the pass, and writes them
+/// as JSON Lines for tools that drive the analysis.
+///
+//===----------------------------------------------------------------------===//
+
+#include "ErrorReport.h"
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+#include <vector>
+#include "llvm/IR/Function.h"
+#include "llvm/IR/InstIterator.h"
+#include "llvm/Support/Debug.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/JSON.h"
+
+namespace ErrorProp {
+
+#define DEBUG_TYPE "errorprop"
+
+using namespace llvm;
+
+json::Value errorToJSON(double Error) {
+  if (std::isnan(Error))
+    return "nan";
+  if (std::isinf(Error))
+    return (Error > 0.0) ? "inf" : "-inf";
+  return Error;
+}
+
+void ErrorReport::recordError(const Instruction &I, double Error) {
+  Errors[&I] = Error;
+}
+
+void ErrorReport::recordCmp(const Instruction &I,
+			    const mdutils::CmpErrorInfo &Info) {
+  Cmps[&I] = CmpRecord{static_cast<double>(Info.MaxTolerance), Info.MayBeWrong};
+}
+
+void ErrorReport::write(raw_ostream &OS, const Module &M,
+			const RangeErrorMap &GlobalRMap) const {
+  // Targets are hashed by name, sort them for a deterministic output.
+  std::vector<std::pair<StringRef, double>> Targets;
+  for (const auto &T : GlobalRMap.getTargetErrors())
+    Targets.push_back(std::make_pair(T.first, static_cast<double>(T.second)));
+  std::sort(Targets.begin(), Targets.end());
+
+  for (const auto &T : Targets)
+    OS << json::Value(json::Object{{"kind", "target"},
+				   {"name", T.first},
+				   {"error", errorToJSON(T.second)}}) << "\n";
+
+  for (const Function &F : M) {
+    if (F.isDeclaration())
+      continue;
+
+    unsigned NumErrors = 0U;
+    for (const Instruction &I : instructions(F))
+      NumErrors += Errors.count(&I) + Cmps.count(&I);
+
+    const AffineForm<inter_t> *FErr = GlobalRMap.getError(&F);
+    if (NumErrors == 0U && FErr == nullptr)
+      continue;
+
+    json::Object FRec{{"kind", "function"},
+		      {"name", F.getName()},
+		      {"instructions", NumErrors}};
+    if (FErr != nullptr)
+      FRec["error"] = errorToJSON(static_cast<double>(FErr->noiseTermsAbsSum()));
+    OS << json::Value(std::move(FRec)) << "\n";
+
+    unsigned Index = 0U;
+    for (const Instruction &I : instructions(F)) {
+      auto Err = Errors.find(&I);
+      if (Err != Errors.end())
+	OS << json::Value(json::Object{{"kind", "instruction"},
+				       {"function", F.getName()},
+				       {"index", Index},
+				       {"opcode", I.getOpcodeName()},
+				       {"error", errorToJSON(Err->second)}}) << "\n";
+
+      auto Cmp = Cmps.find(&I);
+      if (Cmp != Cmps.end())
+	OS << json::Value(json::Object{{"kind", "cmp"},
+				       {"function", F.getName()},
+				       {"index", Index},
+				       {"tolerance", errorToJSON(Cmp->second.Tolerance)},
+				       {"maybewrong", Cmp->second.MayBeWrong}}) << "\n";
+      ++Index;
+    }
+  }
+
+  if (Telemetry != nullptr)
+    Telemetry->write(OS);
+}
+
+bool ErrorReport::writeFile(StringRef Path, const Module &M,
+			    const RangeErrorMap &GlobalRMap) const {
+  std::error_code EC;
+  raw_fd_ostream OS(Path, EC, sys::fs::OF_Text);
+  if (EC) {
+    dbgs() << "[taffo-err] WARNING: cannot write report file " << Path
+	   << ": " << EC.message() << ".\n";
+    return false;
+  }
+
+  write(OS, M, GlobalRMap);
+  return true;
+}
+
+} // end of namespace ErrorProp
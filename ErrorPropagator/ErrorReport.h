@@ -0,0 +1,82 @@
+//===-- ErrorReport.h - Machine-Readable Error Report -----------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// Collects the errors computed by the pass, and writes them
+/// as JSON Lines for tools that drive the analysis.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef ERRORPROPAGATOR_ERROR_REPORT_H
+#define ERRORPROPAGATOR_ERROR_REPORT_H
+
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/IR/Instruction.h"
+#include "llvm/IR/Module.h"
+#include "llvm/Support/JSON.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include "RangeErrorMap.h"
+#include "ErrorTelemetry.h"
+
+namespace ErrorProp {
+
+/// Errors of the instructions of the original functions,
+/// recorded when they are attached as metadata.
+/// Records are written one per line, in this order:
+///   {"kind":"target","name":...,"error":...}, sorted by name;
+/// then for each function, in module order,
+///   {"kind":"function","name":...,"error":...,"instructions":...},
+///   {"kind":"instruction","function":...,"index":...,"opcode":...,"error":...},
+///   {"kind":"cmp","function":...,"index":...,"tolerance":...,"maybewrong":...},
+/// where index is the position of the instruction in its function.
+/// If telemetry is set, its records follow (see ErrorTelemetry::write).
+/// Errors and tolerances are written with errorToJSON.
+class ErrorReport {
+public:
+  ErrorReport() : Telemetry(nullptr) {}
+
+  /// Record the output error of I, replacing any previous one.
+  void recordError(const llvm::Instruction &I, double Error);
+
+  /// Record the comparison error info of I, replacing any previous one.
+  void recordCmp(const llvm::Instruction &I, const mdutils::CmpErrorInfo &Info);
+
+  /// Append the records of T to the report.
+  void setTelemetry(const ErrorTelemetry *T) { Telemetry = T; }
+
+  /// Write all records about M to OS.
+  /// GlobalRMap provides the errors of targets and returned values.
+  void write(llvm::raw_ostream &OS, const llvm::Module &M,
+	     const RangeErrorMap &GlobalRMap) const;
+
+  /// Write all records about M to the file at Path.
+  bool writeFile(llvm::StringRef Path, const llvm::Module &M,
+		 const RangeErrorMap &GlobalRMap) const;
+
+private:
+  struct CmpRecord {
+    double Tolerance;
+    bool MayBeWrong;
+  };
+
+  llvm::DenseMap<const llvm::Instruction *, double> Errors;
+  llvm::DenseMap<const llvm::Instruction *, CmpRecord> Cmps;
+  const ErrorTelemetry *Telemetry;
+};
+
+/// JSON value of an error or tolerance.
+/// JSON numbers cannot be infinite or NaN, so such values are written
+/// as the strings "inf", "-inf" and "nan".
+llvm::json::Value errorToJSON(double Error);
+
+} // end of namespace ErrorProp
+
+#endif // ERRORPROPAGATOR_ERROR_REPORT_H
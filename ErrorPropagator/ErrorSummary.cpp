@@ -0,0 +1,344 @@
+//===-- ErrorSummary.cpp - Function Error Summaries -------------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// Range-to-error transfer summaries of functions,
+/// used instead of analyzing the body of library functions.
+///
+//===----------------------------------------------------------------------===//
+
+#include "ErrorSummary.h"
+
+#include <algorithm>
+#include <cmath>
+#include "llvm/IR/CallSite.h"
+#include "llvm/IR/Constants.h"
+#include "llvm/IR/Function.h"
+#include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/Metadata.h"
+#include "llvm/IRReader/IRReader.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/SourceMgr.h"
+#include "llvm/Support/Debug.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/YAMLTraits.h"
+#include "llvm/Support/raw_ostream.h"
+
+namespace ErrorProp {
+
+/// Contents of a summary file.
+struct ErrorSummaryFile {
+  std::vector<ErrorSummary> Summaries;
+};
+
+} // end of namespace ErrorProp
+
+LLVM_YAML_IS_SEQUENCE_VECTOR(ErrorProp::ErrorSummary::ArgRange)
+LLVM_YAML_IS_SEQUENCE_VECTOR(ErrorProp::ErrorSummary)
+
+namespace llvm {
+namespace yaml {
+
+template <>
+struct MappingTraits<ErrorProp::ErrorSummary::ArgRange> {
+  static void mapping(IO &IO, ErrorProp::ErrorSummary::ArgRange &R) {
+    IO.mapRequired("min", R.Min);
+    IO.mapRequired("max", R.Max);
+    IO.mapOptional("maxerror", R.MaxError,
+		   std::numeric_limits<double>::infinity());
+  }
+
+  static const bool flow = true;
+};
+
+template <>
+struct MappingTraits<ErrorProp::ErrorSummary> {
+  static void mapping(IO &IO, ErrorProp::ErrorSummary &S) {
+    IO.mapRequired("name", S.Name);
+    IO.mapOptional("args", S.Args);
+    IO.mapOptional("sensitivity", S.Sensitivity);
+    IO.mapOptional("error", S.Error, 0.0);
+  }
+
+  static StringRef validate(IO &IO, ErrorProp::ErrorSummary &S) {
+    if (S.Sensitivity.size() > S.Args.size())
+      return "more sensitivities than arguments";
+    return StringRef();
+  }
+};
+
+template <>
+struct MappingTraits<ErrorProp::ErrorSummaryFile> {
+  static void mapping(IO &IO, ErrorProp::ErrorSummaryFile &F) {
+    IO.mapRequired("summaries", F.Summaries);
+  }
+};
+
+} // end of namespace yaml
+} // end of namespace llvm
+
+namespace ErrorProp {
+
+#define DEBUG_TYPE "errorprop"
+
+using namespace llvm;
+
+bool ErrorSummary::coversCall(const Instruction &Call,
+			      const RangeErrorMap &RMap) const {
+  ImmutableCallSite CS(&Call);
+  if (!CS || CS.arg_size() != Args.size())
+    return false;
+
+  for (unsigned Idx = 0U; Idx < Args.size(); ++Idx) {
+    // Arguments with unknown range may be out of range.
+    const FPInterval *R = RMap.getRange(CS.getArgument(Idx));
+    if (R == nullptr || std::isnan(R->Min) || std::isnan(R->Max)
+	|| R->Min < Args[Idx].Min || R->Max > Args[Idx].Max) {
+      LLVM_DEBUG(dbgs() << "(summary of " << Name << " does not cover argument "
+		 << Idx << ") ");
+      return false;
+    }
+
+    // The sensitivity holds only for errors up to MaxError.
+    const AffineForm<inter_t> *E = RMap.getError(CS.getArgument(Idx));
+    if (E != nullptr && E->noiseTermsAbsSum() > Args[Idx].MaxError) {
+      LLVM_DEBUG(dbgs() << "(summary of " << Name
+		 << " does not cover the error on argument " << Idx << ") ");
+      return false;
+    }
+  }
+  return true;
+}
+
+bool ErrorSummary::merge(const ErrorSummary &O) {
+  if (O.Args.size() != Args.size())
+    return false;
+
+  std::vector<ArgRange> NewArgs(Args);
+  for (unsigned Idx = 0U; Idx < Args.size(); ++Idx) {
+    NewArgs[Idx].Min = std::max(Args[Idx].Min, O.Args[Idx].Min);
+    NewArgs[Idx].Max = std::min(Args[Idx].Max, O.Args[Idx].Max);
+    NewArgs[Idx].MaxError = std::min(Args[Idx].MaxError, O.Args[Idx].MaxError);
+    if (NewArgs[Idx].Min > NewArgs[Idx].Max)
+      return false;
+  }
+  Args = std::move(NewArgs);
+
+  if (Sensitivity.size() < O.Sensitivity.size())
+    Sensitivity.resize(O.Sensitivity.size(), 0.0);
+  for (unsigned Idx = 0U; Idx < O.Sensitivity.size(); ++Idx)
+    Sensitivity[Idx] = std::max(Sensitivity[Idx], O.Sensitivity[Idx]);
+  Error = std::max(Error, O.Error);
+  return true;
+}
+
+void ErrorSummaryDB::addSummary(const ErrorSummary &S) {
+  auto Ins = Summaries.insert(std::make_pair(S.Name, S));
+  if (!Ins.second && !Ins.first->second.merge(S))
+    LLVM_DEBUG(dbgs() << "[taffo-err] WARNING: summaries of " << S.Name
+	       << " have disjoint ranges, keeping the first one.\n");
+}
+
+const ErrorSummary *ErrorSummaryDB::lookup(StringRef Name) const {
+  auto It = Summaries.find(Name);
+  return (It != Summaries.end()) ? &It->second : nullptr;
+}
+
+const ErrorSummary *
+ErrorSummaryDB::getSummaryForCall(const Instruction &Call,
+				  const RangeErrorMap &RMap) const {
+  ImmutableCallSite CS(&Call);
+  if (!CS)
+    return nullptr;
+
+  const Function *Callee = CS.getCalledFunction();
+  if (Callee == nullptr || !Callee->hasName())
+    return nullptr;
+
+  const ErrorSummary *S = lookup(Callee->getName());
+  if (S == nullptr || !S->coversCall(Call, RMap))
+    return nullptr;
+
+  return S;
+}
+
+bool ErrorSummaryDB::readFile(StringRef Path) {
+  StringRef Ext = sys::path::extension(Path);
+  if (Ext == ".bc" || Ext == ".ll")
+    return readIRFile(Path);
+  return readYAMLFile(Path);
+}
+
+bool ErrorSummaryDB::readYAMLFile(StringRef Path) {
+  ErrorOr<std::unique_ptr<MemoryBuffer>> Buf = MemoryBuffer::getFile(Path);
+  if (!Buf) {
+    dbgs() << "[taffo-err] WARNING: cannot read summary file " << Path
+	   << ": " << Buf.getError().message() << ".\n";
+    return false;
+  }
+
+  ErrorSummaryFile File;
+  yaml::Input In((*Buf)->getBuffer());
+  In >> File;
+  if (In.error()) {
+    dbgs() << "[taffo-err] WARNING: malformed summary file " << Path << ".\n";
+    return false;
+  }
+
+  for (const ErrorSummary &S : File.Summaries)
+    addSummary(S);
+
+  LLVM_DEBUG(dbgs() << "[taffo-err] Read " << File.Summaries.size()
+	     << " function summaries from " << Path << ".\n");
+  return true;
+}
+
+bool ErrorSummaryDB::writeFile(StringRef Path) const {
+  std::error_code EC;
+  raw_fd_ostream OS(Path, EC, sys::fs::OF_Text);
+  if (EC) {
+    dbgs() << "[taffo-err] WARNING: cannot write summary file " << Path
+	   << ": " << EC.message() << ".\n";
+    return false;
+  }
+
+  // Sort by name, so that output does not depend on hashing.
+  ErrorSummaryFile File;
+  File.Summaries.reserve(Summaries.size());
+  for (const auto &S : Summaries)
+    File.Summaries.push_back(S.second);
+  std::sort(File.Summaries.begin(), File.Summaries.end(),
+	    [](const ErrorSummary &A, const ErrorSummary &B) {
+	      return A.Name < B.Name;
+	    });
+
+  yaml::Output Out(OS);
+  Out << File;
+  return true;
+}
+
+bool ErrorSummaryDB::readIRFile(StringRef Path) {
+  // Bitcode function bodies are materialized lazily, and never here.
+  LLVMContext Context;
+  SMDiagnostic Err;
+  std::unique_ptr<Module> M = getLazyIRFileModule(Path, Err, Context);
+  if (M == nullptr || M->materializeMetadata()) {
+    dbgs() << "[taffo-err] WARNING: cannot read summaries from " << Path
+	   << ": " << Err.getMessage() << ".\n";
+    return false;
+  }
+
+  unsigned N = readModuleMetadata(*M);
+
+  LLVM_DEBUG(dbgs() << "[taffo-err] Read " << N
+	     << " function summaries from " << Path << ".\n");
+  return true;
+}
+
+namespace {
+
+const char *const SummariesMDName = "taffo.errsummaries";
+
+double getMDDouble(const MDOperand &Op, bool &Valid) {
+  auto *C = mdconst::dyn_extract_or_null<ConstantFP>(Op);
+  if (C == nullptr || !C->getType()->isDoubleTy()) {
+    Valid = false;
+    return 0.0;
+  }
+  return C->getValueAPF().convertToDouble();
+}
+
+} // end of anonymous namespace
+
+unsigned ErrorSummaryDB::readModuleMetadata(const Module &M) {
+  const NamedMDNode *NMD = M.getNamedMetadata(SummariesMDName);
+  if (NMD == nullptr)
+    return 0U;
+
+  // Each summary is !{!"name", double Error, !{double Min, double Max, ...},
+  //                   !{double Sensitivity, ...}[, !{double MaxError, ...}]}
+  unsigned N = 0U;
+  for (const MDNode *Node : NMD->operands()) {
+    if (Node->getNumOperands() != 4U && Node->getNumOperands() != 5U)
+      continue;
+    auto *Name = dyn_cast_or_null<MDString>(Node->getOperand(0U));
+    auto *ArgsMD = dyn_cast_or_null<MDNode>(Node->getOperand(2U));
+    auto *SensMD = dyn_cast_or_null<MDNode>(Node->getOperand(3U));
+    if (Name == nullptr || ArgsMD == nullptr || SensMD == nullptr
+	|| ArgsMD->getNumOperands() % 2U != 0U
+	|| SensMD->getNumOperands() * 2U > ArgsMD->getNumOperands())
+      continue;
+
+    bool Valid = true;
+    ErrorSummary S;
+    S.Name = Name->getString().str();
+    S.Error = getMDDouble(Node->getOperand(1U), Valid);
+    for (unsigned Idx = 0U; Idx < ArgsMD->getNumOperands(); Idx += 2U) {
+      ErrorSummary::ArgRange R;
+      R.Min = getMDDouble(ArgsMD->getOperand(Idx), Valid);
+      R.Max = getMDDouble(ArgsMD->getOperand(Idx + 1U), Valid);
+      S.Args.push_back(R);
+    }
+    for (const MDOperand &Op : SensMD->operands())
+      S.Sensitivity.push_back(getMDDouble(Op, Valid));
+    if (Node->getNumOperands() == 5U) {
+      auto *MaxErrMD = dyn_cast_or_null<MDNode>(Node->getOperand(4U));
+      if (MaxErrMD == nullptr || MaxErrMD->getNumOperands() != S.Args.size())
+	continue;
+      for (unsigned Idx = 0U; Idx < S.Args.size(); ++Idx)
+	S.Args[Idx].MaxError = getMDDouble(MaxErrMD->getOperand(Idx), Valid);
+    }
+
+    if (!Valid)
+      continue;
+    addSummary(S);
+    ++N;
+  }
+  return N;
+}
+
+void ErrorSummaryDB::writeModuleMetadata(Module &M) const {
+  NamedMDNode *NMD = M.getOrInsertNamedMetadata(SummariesMDName);
+  NMD->clearOperands();
+
+  LLVMContext &C = M.getContext();
+  Type *DoubleTy = Type::getDoubleTy(C);
+  auto getMD = [&](double V) -> Metadata * {
+    return ConstantAsMetadata::get(ConstantFP::get(DoubleTy, V));
+  };
+
+  std::vector<const ErrorSummary *> Sorted;
+  for (const auto &S : Summaries)
+    Sorted.push_back(&S.second);
+  std::sort(Sorted.begin(), Sorted.end(),
+	    [](const ErrorSummary *A, const ErrorSummary *B) {
+	      return A->Name < B->Name;
+	    });
+
+  for (const ErrorSummary *S : Sorted) {
+    SmallVector<Metadata *, 8U> ArgsMD;
+    SmallVector<Metadata *, 4U> MaxErrMD;
+    for (const ErrorSummary::ArgRange &R : S->Args) {
+      ArgsMD.push_back(getMD(R.Min));
+      ArgsMD.push_back(getMD(R.Max));
+      MaxErrMD.push_back(getMD(R.MaxError));
+    }
+    SmallVector<Metadata *, 4U> SensMD;
+    for (double Sens : S->Sensitivity)
+      SensMD.push_back(getMD(Sens));
+
+    Metadata *MDs[] = { MDString::get(C, S->Name), getMD(S->Error),
+			MDNode::get(C, ArgsMD), MDNode::get(C, SensMD),
+			MDNode::get(C, MaxErrMD) };
+    NMD->addOperand(MDNode::get(C, MDs));
+  }
+}
+
+} // end of namespace ErrorProp
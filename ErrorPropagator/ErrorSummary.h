@@ -0,0 +1,100 @@
+//===-- ErrorSummary.h - Function Error Summaries ---------------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// Range-to-error transfer summaries of functions,
+/// used instead of analyzing the body of library functions.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef ERRORPROPAGATOR_ERROR_SUMMARY_H
+#define ERRORPROPAGATOR_ERROR_SUMMARY_H
+
+#include <limits>
+#include <string>
+#include <vector>
+#include "llvm/ADT/StringMap.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/IR/Instruction.h"
+#include "llvm/IR/Module.h"
+
+#include "RangeErrorMap.h"
+
+namespace ErrorProp {
+
+/// Transfer summary of a function with scalar arguments.
+/// The absolute error on the returned value is
+///   Error + sum_i Sensitivity[i] * (error on argument i),
+/// as long as each argument i lies within Args[i]
+/// with an error not larger than Args[i].MaxError.
+struct ErrorSummary {
+  struct ArgRange {
+    double Min = 0.0;
+    double Max = 0.0;
+    /// Largest error on the argument for which the sensitivity holds.
+    double MaxError = std::numeric_limits<double>::infinity();
+  };
+
+  std::string Name;
+  std::vector<ArgRange> Args;
+  std::vector<double> Sensitivity;
+  /// Error on the returned value when the arguments are exact.
+  double Error = 0.0;
+
+  /// True if the ranges of the actual arguments of Call
+  /// are known, and lie within the ranges in Args,
+  /// and their errors are within the maximum errors in Args.
+  bool coversCall(const llvm::Instruction &Call, const RangeErrorMap &RMap) const;
+
+  /// Combine with another summary of the same function,
+  /// keeping the ranges where both are valid and the largest errors.
+  /// Returns false, leaving this summary unchanged, if they have no common ranges.
+  bool merge(const ErrorSummary &O);
+};
+
+/// Collection of error summaries, read from and written to YAML files
+/// or embedded in modules as named metadata.
+class ErrorSummaryDB {
+public:
+  bool empty() const { return Summaries.empty(); }
+
+  /// Add S, merging it with any summary with the same name.
+  void addSummary(const ErrorSummary &S);
+
+  const ErrorSummary *lookup(llvm::StringRef Name) const;
+
+  /// The summary of the function called by Call, if it covers Call.
+  const ErrorSummary *getSummaryForCall(const llvm::Instruction &Call,
+					const RangeErrorMap &RMap) const;
+
+  /// Add all summaries in the file at Path, which is either YAML
+  /// or an IR module with embedded summaries (.ll or .bc).
+  /// Function bodies of bitcode modules are not loaded.
+  /// Returns false and prints a warning if the file cannot be read.
+  bool readFile(llvm::StringRef Path);
+
+  /// Write all summaries to the YAML file at Path.
+  bool writeFile(llvm::StringRef Path) const;
+
+  /// Add the summaries embedded in M. Returns their number.
+  unsigned readModuleMetadata(const llvm::Module &M);
+
+  /// Embed all summaries in M, replacing those already there.
+  void writeModuleMetadata(llvm::Module &M) const;
+
+private:
+  llvm::StringMap<ErrorSummary> Summaries;
+
+  bool readYAMLFile(llvm::StringRef Path);
+  bool readIRFile(llvm::StringRef Path);
+};
+
+} // end of namespace ErrorProp
+
+#endif // ERRORPROPAGATOR_ERROR_SUMMARY_H
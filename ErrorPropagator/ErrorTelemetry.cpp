@@ -0,0 +1,138 @@
+//===-- ErrorTelemetry.cpp - Noise Term and Memory Telemetry ----*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// Records how the number of noise terms grows during the analysis,
+/// and the peak memory held by errors, struct fields and function copies.
+///
+//===----------------------------------------------------------------------===//
+
+#include "ErrorTelemetry.h"
+
+#include <algorithm>
+#include <string>
+#include <utility>
+#include "llvm/Support/MathExtras.h"
+
+namespace ErrorProp {
+
+using namespace llvm;
+
+void NoiseTermHistogram::add(size_t NumNoiseTerms) {
+  unsigned Bucket = (NumNoiseTerms == 0U) ? 0U : Log2_64(NumNoiseTerms) + 1U;
+  if (Buckets.size() <= Bucket)
+    Buckets.resize(Bucket + 1U, 0U);
+  ++Buckets[Bucket];
+  ++Errors;
+  NoiseTerms += NumNoiseTerms;
+  MaxNoiseTerms = std::max(MaxNoiseTerms, NumNoiseTerms);
+}
+
+void NoiseTermHistogram::toJSON(json::Object &Rec) const {
+  Rec["errors"] = static_cast<int64_t>(Errors);
+  Rec["noiseterms"] = static_cast<int64_t>(NoiseTerms);
+  Rec["maxnoiseterms"] = static_cast<int64_t>(MaxNoiseTerms);
+
+  json::Object B;
+  for (unsigned Bucket = 0U; Bucket < Buckets.size(); ++Bucket) {
+    if (Buckets[Bucket] == 0U)
+      continue;
+    uint64_t Low = (Bucket == 0U) ? 0U : (UINT64_C(1) << (Bucket - 1U));
+    B[std::to_string(Low)] = static_cast<int64_t>(Buckets[Bucket]);
+  }
+  Rec["buckets"] = std::move(B);
+}
+
+void ErrorTelemetry::recordError(const Instruction &I, const Function &F,
+				 size_t NumNoiseTerms) {
+  Opcodes[I.getOpcode()].add(NumNoiseTerms);
+  Functions[F.getName()].add(NumNoiseTerms);
+}
+
+void ErrorTelemetry::enter(const RangeErrorMap &RMap) {
+  LiveMap L;
+  L.Map = &RMap;
+  L.Usage = RangeErrorMap::MemoryUsage{0U, 0U, 0U};
+  Stack.push_back(L);
+}
+
+void ErrorTelemetry::exit() {
+  assert(!Stack.empty() && "Unbalanced error telemetry scope.");
+  sampleMaps();
+  Stack.pop_back();
+}
+
+void ErrorTelemetry::sampleMaps() {
+  if (Stack.empty())
+    return;
+
+  // Enclosing maps do not change while a nested analysis is running,
+  // so only the innermost one is measured again.
+  Stack.back().Usage = Stack.back().Map->getMemoryUsage();
+  updatePeaks();
+}
+
+void ErrorTelemetry::updatePeaks() {
+  size_t Entries = 0U;
+  size_t AffineBytes = 0U;
+  size_t StructBytes = 0U;
+  for (const LiveMap &L : Stack) {
+    Entries += L.Usage.Entries;
+    AffineBytes += L.Usage.AffineBytes;
+    StructBytes += L.Usage.StructBytes;
+  }
+
+  PeakEntries = std::max(PeakEntries, Entries);
+  PeakAffineBytes = std::max(PeakAffineBytes, AffineBytes);
+  PeakStructBytes = std::max(PeakStructBytes, StructBytes);
+  PeakCopyBytes = std::max(PeakCopyBytes, CopyBytes);
+  PeakBytes = std::max(PeakBytes, AffineBytes + StructBytes + CopyBytes);
+}
+
+void ErrorTelemetry::addFunctionCopy(size_t Bytes) {
+  CopyBytes += Bytes;
+  updatePeaks();
+}
+
+void ErrorTelemetry::removeFunctionCopy(size_t Bytes) {
+  assert(Bytes <= CopyBytes && "Unbalanced function copy size.");
+  CopyBytes -= Bytes;
+}
+
+void ErrorTelemetry::write(raw_ostream &OS) const {
+  for (const auto &Op : Opcodes) {
+    json::Object Rec{{"kind", "noiseterms"},
+		     {"opcode", Instruction::getOpcodeName(Op.first)}};
+    Op.second.toJSON(Rec);
+    OS << json::Value(std::move(Rec)) << "\n";
+  }
+
+  // Functions are hashed by name, sort them for a deterministic output.
+  std::vector<StringRef> Names;
+  for (const auto &F : Functions)
+    Names.push_back(F.first());
+  std::sort(Names.begin(), Names.end());
+  for (StringRef Name : Names) {
+    json::Object Rec{{"kind", "noiseterms"},
+		     {"function", Name}};
+    Functions.lookup(Name).toJSON(Rec);
+    OS << json::Value(std::move(Rec)) << "\n";
+  }
+
+  OS << json::Value(json::Object{
+      {"kind", "memory"},
+      {"symbols", static_cast<int64_t>(NoiseTermBase::getNextSymId() - FirstSymId)},
+      {"mapentries", static_cast<int64_t>(PeakEntries)},
+      {"affinebytes", static_cast<int64_t>(PeakAffineBytes)},
+      {"structbytes", static_cast<int64_t>(PeakStructBytes)},
+      {"copybytes", static_cast<int64_t>(PeakCopyBytes)},
+      {"bytes", static_cast<int64_t>(PeakBytes)}}) << "\n";
+}
+
+} // end of namespace ErrorProp
@@ -0,0 +1,126 @@
+//===-- ErrorTelemetry.h - Noise Term and Memory Telemetry ------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// Records how the number of noise terms grows during the analysis,
+/// and the peak memory held by errors, struct fields and function copies.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef ERRORPROPAGATOR_ERROR_TELEMETRY_H
+#define ERRORPROPAGATOR_ERROR_TELEMETRY_H
+
+#include <cstdint>
+#include <map>
+#include <vector>
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/IR/Function.h"
+#include "llvm/IR/Instruction.h"
+#include "llvm/Support/JSON.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include "AffineForms.h"
+#include "RangeErrorMap.h"
+
+namespace ErrorProp {
+
+/// Number of noise terms of the computed errors, in power-of-two buckets:
+/// bucket 0 counts errors with no noise terms,
+/// bucket K errors with 2^(K-1) to 2^K - 1 noise terms.
+struct NoiseTermHistogram {
+  llvm::SmallVector<uint64_t, 8U> Buckets;
+  uint64_t Errors = 0U;
+  uint64_t NoiseTerms = 0U;
+  size_t MaxNoiseTerms = 0U;
+
+  void add(size_t NumNoiseTerms);
+
+  /// Write the fields of the histogram in Rec.
+  /// Buckets are keyed by their smallest number of noise terms.
+  void toJSON(llvm::json::Object &Rec) const;
+};
+
+/// Collects noise term histograms per opcode and per function,
+/// the number of noise symbols allocated,
+/// and the peak size of the data held by the running analyses.
+class ErrorTelemetry {
+public:
+  /// Tracks the map of a function analysis while in scope.
+  /// Does nothing if the telemetry is null.
+  class Scope {
+  public:
+    Scope(ErrorTelemetry *T, const RangeErrorMap &RMap) : T(T) {
+      if (T)
+	T->enter(RMap);
+    }
+    Scope(const Scope &) = delete;
+    Scope &operator=(const Scope &) = delete;
+    ~Scope() {
+      if (T)
+	T->exit();
+    }
+  private:
+    ErrorTelemetry *T;
+  };
+
+  ErrorTelemetry() : FirstSymId(NoiseTermBase::getNextSymId()) {}
+
+  /// Count the error computed for I, a copy of an instruction of F,
+  /// with NumNoiseTerms noise terms.
+  void recordError(const llvm::Instruction &I, const llvm::Function &F,
+		   size_t NumNoiseTerms);
+
+  /// Measure the map of the innermost analysis,
+  /// which must be done before it starts a nested analysis.
+  void sampleMaps();
+
+  /// Account for a new function copy of Bytes bytes.
+  void addFunctionCopy(size_t Bytes);
+
+  /// Account for a dropped function copy of Bytes bytes.
+  void removeFunctionCopy(size_t Bytes);
+
+  /// Write the telemetry as JSON Lines:
+  ///   {"kind":"noiseterms","opcode":...,<histogram>}, by opcode;
+  ///   {"kind":"noiseterms","function":...,<histogram>}, sorted by name;
+  ///   {"kind":"memory","symbols":...,"mapentries":...,"affinebytes":...,
+  ///    "structbytes":...,"copybytes":...,"bytes":...},
+  /// where <histogram> is "errors", "noiseterms", "maxnoiseterms"
+  /// and "buckets", and memory fields are peaks over the whole run.
+  void write(llvm::raw_ostream &OS) const;
+
+private:
+  struct LiveMap {
+    const RangeErrorMap *Map;
+    RangeErrorMap::MemoryUsage Usage;
+  };
+
+  NoiseTermBase::SymbolT FirstSymId;
+  std::map<unsigned, NoiseTermHistogram> Opcodes;
+  llvm::StringMap<NoiseTermHistogram> Functions;
+
+  /// Maps of the analyses in progress, innermost last.
+  std::vector<LiveMap> Stack;
+  size_t CopyBytes = 0U;
+
+  size_t PeakEntries = 0U;
+  size_t PeakAffineBytes = 0U;
+  size_t PeakStructBytes = 0U;
+  size_t PeakCopyBytes = 0U;
+  size_t PeakBytes = 0U;
+
+  void enter(const RangeErrorMap &RMap);
+  void exit();
+  void updatePeaks();
+};
+
+} // end of namespace ErrorProp
+
+#endif // ERRORPROPAGATOR_ERROR_TELEMETRY_H
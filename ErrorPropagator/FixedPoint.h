@@ -69,6 +69,9 @@ public:
 
   bool isUninitialized() const { return IInfo == nullptr; }
 
+  /// False if the bounds are unknown (NaN), e.g. for empty vector lanes.
+  bool hasBounds() const { return !std::isnan(Min) && !std::isnan(Max); }
+
   const mdutils::TType *getTType() const {
     if (isUninitialized())
       return nullptr;
@@ -0,0 +1,284 @@
+//===-- FixedPointIntrinsics.cpp - Fixed Point Intrinsics -------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// Definitions of functions that propagate errors for the LLVM
+/// fixed point and saturating arithmetic intrinsics.
+///
+//===----------------------------------------------------------------------===//
+
+#include "Propagators.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+#include <limits>
+#include <tuple>
+#include "llvm/ADT/StringSwitch.h"
+#include "llvm/IR/Constants.h"
+#include "llvm/IR/Instructions.h"
+#include "llvm/Support/Debug.h"
+
+namespace ErrorProp {
+
+#define DEBUG_TYPE "errorprop"
+
+using namespace llvm;
+
+namespace {
+
+enum FixedPointOpKind {
+  FPK_None,
+  FPK_Mul,
+  FPK_Div,
+  FPK_Add,
+  FPK_Sub
+};
+
+struct FixedPointIntrinsicInfo {
+  FixedPointOpKind Kind = FPK_None;
+  bool Signed = false;
+  bool Saturating = false;
+  /// True if the third argument is the scale (number of fractional bits).
+  bool HasScale = false;
+};
+
+/// Decode names such as llvm.smul.fix.sat.i32 or llvm.uadd.sat.v4i16.
+FixedPointIntrinsicInfo getFixedPointIntrinsicInfo(StringRef Name) {
+  FixedPointIntrinsicInfo Info;
+  if (!Name.consume_front("llvm."))
+    return Info;
+
+  StringRef Op, Suffix, Rest;
+  std::tie(Op, Rest) = Name.split('.');
+  std::tie(Suffix, Rest) = Rest.split('.');
+  if (Op.empty() || (Op.front() != 's' && Op.front() != 'u'))
+    return Info;
+
+  FixedPointOpKind Kind = StringSwitch<FixedPointOpKind>(Op.drop_front())
+    .Case("mul", FPK_Mul)
+    .Case("div", FPK_Div)
+    .Case("add", FPK_Add)
+    .Case("sub", FPK_Sub)
+    .Default(FPK_None);
+
+  if (Kind == FPK_Mul || Kind == FPK_Div) {
+    if (Suffix != "fix")
+      return Info;
+    Info.HasScale = true;
+    Info.Saturating = Rest == "sat" || Rest.startswith("sat.");
+  }
+  else if (Kind == FPK_Add || Kind == FPK_Sub) {
+    if (Suffix != "sat")
+      return Info;
+    Info.Saturating = true;
+  }
+  else
+    return Info;
+
+  Info.Kind = Kind;
+  Info.Signed = Op.front() == 's';
+  return Info;
+}
+
+/// Opcode of the instruction with the same error propagation rule,
+/// disregarding the truncation of the result.
+unsigned getEquivalentOpcode(FixedPointOpKind Kind) {
+  switch (Kind) {
+    case FPK_Mul:
+      return Instruction::Mul;
+    case FPK_Div:
+      // FDiv propagates division errors with no truncation.
+      return Instruction::FDiv;
+    case FPK_Add:
+      return Instruction::Add;
+    case FPK_Sub:
+      return Instruction::Sub;
+    default:
+      llvm_unreachable("Not a fixed point intrinsic.");
+  }
+}
+
+/// Compute the bounds of the values representable with Width bits,
+/// Frac of which are fractional (a negative Frac scales the values up).
+void getFixedPointBounds(unsigned Width, int Frac, bool Signed,
+			 inter_t &Min, inter_t &Max) {
+  inter_t Ulp = std::ldexp(static_cast<inter_t>(1.0), -Frac);
+  if (Signed) {
+    Min = -std::ldexp(static_cast<inter_t>(1.0), Width - 1U) * Ulp;
+    Max = (std::ldexp(static_cast<inter_t>(1.0), Width - 1U) - 1) * Ulp;
+  }
+  else {
+    Min = 0;
+    Max = (std::ldexp(static_cast<inter_t>(1.0), Width) - 1) * Ulp;
+  }
+}
+
+/// Number of fractional bits of the fixed point type of R, or Default.
+int getFractionalBits(const FPInterval &R, int Default) {
+  const mdutils::FPType *Ty = dyn_cast_or_null<mdutils::FPType>(R.getTType());
+  return (Ty != nullptr) ? static_cast<int>(Ty->getPointPos()) : Default;
+}
+
+/// Range of the exact result of Kind on operands in R1 and R2.
+/// Bounds are NaN if the operand ranges are unknown.
+Interval<inter_t> getExactResultRange(FixedPointOpKind Kind,
+				      const FPInterval &R1, const FPInterval &R2) {
+  const inter_t NaN = std::numeric_limits<inter_t>::quiet_NaN();
+  if (!R1.hasBounds() || !R2.hasBounds())
+    return Interval<inter_t>(NaN, NaN);
+
+  switch (Kind) {
+    case FPK_Add:
+      return Interval<inter_t>(R1.Min + R2.Min, R1.Max + R2.Max);
+    case FPK_Sub:
+      return Interval<inter_t>(R1.Min - R2.Max, R1.Max - R2.Min);
+    case FPK_Div:
+      if (R2.Min <= 0.0 && R2.Max >= 0.0)
+	return Interval<inter_t>(-std::numeric_limits<inter_t>::infinity(),
+				 std::numeric_limits<inter_t>::infinity());
+      LLVM_FALLTHROUGH;
+    case FPK_Mul: {
+      inter_t Y1 = (Kind == FPK_Mul) ? R2.Min : 1 / R2.Min;
+      inter_t Y2 = (Kind == FPK_Mul) ? R2.Max : 1 / R2.Max;
+      inter_t P[] = { R1.Min * Y1, R1.Min * Y2, R1.Max * Y1, R1.Max * Y2 };
+      return Interval<inter_t>(*std::min_element(std::begin(P), std::end(P)),
+			       *std::max_element(std::begin(P), std::end(P)));
+    }
+    default:
+      llvm_unreachable("Not a fixed point intrinsic.");
+  }
+}
+
+} // end of anonymous namespace
+
+bool InstructionPropagator::isFixedPointIntrinsic(Function &F) {
+  return F.isIntrinsic()
+    && getFixedPointIntrinsicInfo(F.getName()).Kind != FPK_None;
+}
+
+bool InstructionPropagator::propagateFixedPointIntrinsic(Instruction &I, Function &Called) {
+  FixedPointIntrinsicInfo Info = getFixedPointIntrinsicInfo(Called.getName());
+  assert(Info.Kind != FPK_None);
+  LLVM_DEBUG(logInfo("(fixed point intrinsic)"));
+
+  CallInst &CI = cast<CallInst>(I);
+  unsigned Scale = 0U;
+  if (Info.HasScale) {
+    ConstantInt *CScale = dyn_cast<ConstantInt>(CI.getArgOperand(2U));
+    if (CScale == nullptr) {
+      LLVM_DEBUG(logInfoln("ignored (unknown scale)."));
+      return false;
+    }
+    Scale = CScale->getZExtValue();
+  }
+  const FPInterval *ResR = RMap.getRange(&I);
+  unsigned Width = I.getType()->getScalarSizeInBits();
+
+  // Truncation and saturation errors of a result with operands in R1 and R2.
+  auto computeExtraError = [&](const FPInterval &R1, const FPInterval &R2) -> inter_t {
+    // The operands have Scale fractional bits, unless their type says otherwise.
+    int Frac1 = getFractionalBits(R1, Scale);
+    int Frac2 = getFractionalBits(R2, Scale);
+    // The product of the operands has Frac1 + Frac2 fractional bits,
+    // and the dividend is shifted left by Scale bits before the division,
+    // then the result is truncated to ResFrac bits,
+    // which loses up to one unit in the last place.
+    int ResFrac;
+    if (Info.Kind == FPK_Mul)
+      ResFrac = Frac1 + Frac2 - static_cast<int>(Scale);
+    else if (Info.Kind == FPK_Div)
+      ResFrac = Frac1 + static_cast<int>(Scale) - Frac2;
+    else
+      ResFrac = Frac1;
+    if (ResR != nullptr)
+      ResFrac = getFractionalBits(*ResR, ResFrac);
+    inter_t TruncError = Info.HasScale
+      ? std::ldexp(static_cast<inter_t>(1.0), -ResFrac) : 0.0;
+
+    // Saturation clamps the result to the representable range.
+    // Clamping never increases the distance between two values,
+    // so the error bound is the same as without saturation,
+    // as long as the exact result does not overflow.
+    // Otherwise, the result may be off by as much as it is clipped.
+    if (!Info.Saturating)
+      return TruncError;
+
+    inter_t Min, Max;
+    if (ResR != nullptr && ResR->getTType() != nullptr) {
+      Min = ResR->getTType()->getMinValueBound();
+      Max = ResR->getTType()->getMaxValueBound();
+    }
+    else
+      getFixedPointBounds(Width, ResFrac, Info.Signed, Min, Max);
+
+    // Without range metadata, the result range follows from the operands.
+    Interval<inter_t> Exact = (ResR != nullptr && ResR->hasBounds())
+      ? Interval<inter_t>(ResR->Min, ResR->Max)
+      : getExactResultRange(Info.Kind, R1, R2);
+    if (std::isnan(Exact.Min) || std::isnan(Exact.Max))
+      return TruncError;
+
+    inter_t SatError = std::max(std::max(Min - Exact.Min, Exact.Max - Max),
+				static_cast<inter_t>(0.0));
+    if (SatError > 0.0)
+      LLVM_DEBUG(logInfo("(may saturate)"));
+    return TruncError + SatError;
+  };
+
+  unsigned Opcode = getEquivalentOpcode(Info.Kind);
+  unsigned NumLanes = getNumLanes(I.getType());
+  if (NumLanes == 0U) {
+    auto *O1 = getOperandRangeError(I, CI.getArgOperand(0U));
+    auto *O2 = getOperandRangeError(I, CI.getArgOperand(1U));
+    if (O1 == nullptr || !O1->second.hasValue()
+	|| O2 == nullptr || !O2->second.hasValue()) {
+      LLVM_DEBUG(logInfoln("no data."));
+      return false;
+    }
+
+    AffineForm<inter_t> ERes;
+    if (!computeBinaryOpError(Opcode, *O1, *O2, nullptr, ERes))
+      return false;
+    inter_t ExtraError = computeExtraError(O1->first, O2->first);
+    if (ExtraError > 0.0)
+      ERes = ERes + AffineForm<inter_t>(0.0, ExtraError);
+
+    RMap.setError(&I, ERes);
+
+    LLVM_DEBUG(logErrorln(ERes));
+    return true;
+  }
+
+  // Vector operands are processed lane by lane.
+  SmallVector<RangeErrorMap::RangeError, 4U> Lanes;
+  Lanes.reserve(NumLanes);
+  for (unsigned Lane = 0U; Lane < NumLanes; ++Lane) {
+    auto *O1 = getOperandLaneRangeError(I, CI.getArgOperand(0U), Lane);
+    auto *O2 = getOperandLaneRangeError(I, CI.getArgOperand(1U), Lane);
+    if (O1 == nullptr || !O1->second.hasValue()
+	|| O2 == nullptr || !O2->second.hasValue()) {
+      Lanes.push_back(getEmptyLane());
+      continue;
+    }
+
+    AffineForm<inter_t> ERes;
+    if (!computeBinaryOpError(Opcode, *O1, *O2, nullptr, ERes))
+      return false;
+    inter_t ExtraError = computeExtraError(O1->first, O2->first);
+    if (ExtraError > 0.0)
+      ERes = ERes + AffineForm<inter_t>(0.0, ExtraError);
+
+    Lanes.push_back(makeLane(I, ERes));
+  }
+
+  return setLaneErrors(I, Lanes);
+}
+
+} // end of namespace ErrorProp
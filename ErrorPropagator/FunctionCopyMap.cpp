@@ -1,14 +1,21 @@
 #include "FunctionCopyMap.h"
 
 #include "llvm/IR/Dominators.h"
+#include "llvm/IR/Instructions.h"
+#include "llvm/IR/IntrinsicInst.h"
 #include "llvm/Analysis/LoopInfo.h"
 #include "llvm/Analysis/AssumptionCache.h"
 #include "llvm/Analysis/ScalarEvolution.h"
+#include "llvm/Analysis/TargetLibraryInfo.h"
 #include "llvm/Analysis/OptimizationRemarkEmitter.h"
 #include "llvm/Transforms/Utils/UnrollLoop.h"
+#include "llvm/Transforms/Utils/LoopUtils.h"
 #include "llvm/Support/Debug.h"
+#include "llvm/ADT/Statistic.h"
 #include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/SmallPtrSet.h"
 #include "Metadata.h"
+#include "PhaseTimer.h"
 
 namespace ErrorProp {
 
@@ -16,29 +23,165 @@ using namespace llvm;
 
 #define DEBUG_TYPE "errorprop"
 
-void UnrollLoops(Pass &P, Function &F, unsigned DefaultUnrollCount, unsigned MaxUnroll) {
+STATISTIC(NumClones, "Number of function copies created for loop unrolling");
+STATISTIC(NumReusedClones, "Number of unused function copies reused");
+STATISTIC(NumUnrolledLoops, "Number of loops unrolled");
+STATISTIC(NumUnrolledIterations, "Number of loop iterations unrolled");
+
+namespace {
+
+/// Analyses needed to unroll the loops of a function.
+/// They are computed here once, because each request to the on-the-fly
+/// pass manager of the module pass recomputes all function analyses.
+struct LoopAnalyses {
+  DominatorTree DT;
+  LoopInfo LI;
+  ScalarEvolution SE;
+
+  LoopAnalyses(Function &F, TargetLibraryInfo &TLI, AssumptionCache &AC)
+    : DT(F), LI(DT), SE(F, TLI, AC, DT, LI) {}
+};
+
+/// Rough size of the IR of a copy, without types, constants and metadata,
+/// which are shared with the original function.
+size_t estimateCopyBytes(const Function &Copy) {
+  size_t Bytes = sizeof(Function) + Copy.arg_size() * sizeof(Argument);
+  for (const BasicBlock &BB : Copy) {
+    Bytes += sizeof(BasicBlock);
+    for (const Instruction &I : BB)
+      Bytes += sizeof(Instruction) + I.getNumOperands() * sizeof(Use);
+  }
+  return Bytes;
+}
+
+/// Compute the number of times loop L should be unrolled,
+/// and store its trip count (0 if unknown) in TripCount.
+/// If UseProfile is true, the trip count estimated from branch weights
+/// is used when no exact trip count or unroll count metadata is available.
+unsigned computeUnrollCount(ScalarEvolution &SE, LoopInfo &LInfo, Loop *L,
+			    unsigned DefaultUnrollCount, unsigned MaxUnroll,
+			    bool UseProfile, unsigned &TripCount) {
+  // Compute loop trip count
+  TripCount = SE.getSmallConstantTripCount(L);
+  // Get user supplied unroll count
+  Optional<unsigned> OUC = mdutils::MetadataManager::retrieveLoopUnrollCount(*L, &LInfo);
+  unsigned UnrollCount = DefaultUnrollCount;
+  if (OUC.hasValue())
+    if (TripCount != 0 && OUC.getValue() > TripCount)
+      UnrollCount = TripCount;
+    else
+      UnrollCount = OUC.getValue();
+  else if (TripCount != 0)
+    UnrollCount = TripCount;
+  else if (UseProfile) {
+    Optional<unsigned> EstTripCount = getLoopEstimatedTripCount(L);
+    if (EstTripCount.hasValue() && EstTripCount.getValue() > 0U) {
+      LLVM_DEBUG(dbgs() << "[taffo-err] Using profile trip count "
+		 << EstTripCount.getValue() << " for loop "
+		 << L->getHeader()->getName() << ".\n");
+      UnrollCount = EstTripCount.getValue();
+    }
+  }
+
+  if (UnrollCount > MaxUnroll)
+    UnrollCount = MaxUnroll;
+
+  return UnrollCount;
+}
+
+/// Returns false if UnrollLoop would certainly leave L unmodified.
+/// Mirrors the early checks performed by llvm::UnrollLoop.
+bool mayUnrollLoop(Loop *L, unsigned UnrollCount, unsigned TripCount) {
+  if (UnrollCount == 0U
+      || (TripCount == 0U && UnrollCount < 2U))
+    return false;
+
+  if (L->getLoopPreheader() == nullptr
+      || L->getLoopLatch() == nullptr)
+    return false;
+
+  return L->isSafeToClone() && !L->getHeader()->hasAddressTaken();
+}
+
+/// True if I carries range, struct or constant info metadata.
+bool hasRangeMetadata(const Instruction &I) {
+  return I.getMetadata(INPUT_INFO_METADATA) != nullptr
+    || I.getMetadata(STRUCT_INFO_METADATA) != nullptr
+    || I.getMetadata(CONST_INFO_METADATA) != nullptr;
+}
+
+/// True if I calls a function that may contain annotated code.
+bool isNonIntrinsicCall(const Instruction &I) {
+  return (isa<CallInst>(I) || isa<InvokeInst>(I)) && !isa<IntrinsicInst>(I);
+}
+
+/// Cheap check to find out whether unrolling L may affect the computed errors.
+/// Returns true if L contains instructions with range metadata or calls,
+/// or if any value computed in L may flow into an annotated or target instruction,
+/// into memory or into the return value of the function.
+bool isLoopRelevant(const Loop *L) {
+  SmallPtrSet<const Instruction *, 32U> Visited;
+  SmallVector<const Instruction *, 32U> Worklist;
+  for (const BasicBlock *BB : L->blocks()) {
+    for (const Instruction &I : *BB) {
+      if (hasRangeMetadata(I) || isNonIntrinsicCall(I))
+	return true;
+
+      Visited.insert(&I);
+      Worklist.push_back(&I);
+    }
+  }
+
+  // Follow def-use chains of loop values.
+  while (!Worklist.empty()) {
+    const Instruction *I = Worklist.pop_back_val();
+    for (const Use &U : I->uses()) {
+      const Instruction *UI = dyn_cast<Instruction>(U.getUser());
+      if (UI == nullptr)
+	continue;
+
+      if (isa<StoreInst>(UI)) {
+	// Only stored values matter, addresses do not.
+	if (U.getOperandNo() == 0U)
+	  return true;
+	continue;
+      }
+
+      if (isa<ReturnInst>(UI) || isNonIntrinsicCall(*UI) || hasRangeMetadata(*UI)
+	  || mdutils::MetadataManager::retrieveTargetMetadata(*UI).hasValue())
+	return true;
+
+      if (Visited.insert(UI).second)
+	Worklist.push_back(UI);
+    }
+  }
+  return false;
+}
+
+} // end of anonymous namespace
+
+bool UnrollLoops(Pass &P, Function &F, unsigned DefaultUnrollCount, unsigned MaxUnroll,
+		 bool UseProfile,
+		 const SmallPtrSetImpl<const BasicBlock *> *Headers) {
   // Prepare required analyses
-  LoopInfo &LInfo = P.getAnalysis<LoopInfoWrapperPass>(F).getLoopInfo();
+  TargetLibraryInfo &TLI = P.getAnalysis<TargetLibraryInfoWrapperPass>().getTLI(F);
+  AssumptionCache &AssC = P.getAnalysis<AssumptionCacheTracker>().getAssumptionCache(F);
+  LoopAnalyses LA(F, TLI, AssC);
+  OptimizationRemarkEmitter ORE(&F);
+  LoopInfo &LInfo = LA.LI;
+  ScalarEvolution &SE = LA.SE;
   SmallVector<Loop *, 4U> Loops(LInfo.begin(), LInfo.end());
 
+  bool Changed = false;
   // Now try to unroll all loops
   for (Loop *L : Loops) {
-    ScalarEvolution &SE = P.getAnalysis<ScalarEvolutionWrapperPass>(F).getSE();
-    // Compute loop trip count
-    unsigned TripCount = SE.getSmallConstantTripCount(L);
-    // Get user supplied unroll count
-    Optional<unsigned> OUC = mdutils::MetadataManager::retrieveLoopUnrollCount(*L, &LInfo);
-    unsigned UnrollCount = DefaultUnrollCount;
-    if (OUC.hasValue())
-      if (TripCount != 0 && OUC.getValue() > TripCount)
-	UnrollCount = TripCount;
-      else
-	UnrollCount = OUC.getValue();
-    else if (TripCount != 0)
-      UnrollCount = TripCount;
+    if (Headers != nullptr && !Headers->count(L->getHeader()))
+      continue;
 
-    if (UnrollCount > MaxUnroll)
-      UnrollCount = MaxUnroll;
+    unsigned TripCount;
+    unsigned UnrollCount = computeUnrollCount(SE, LInfo, L,
+					      DefaultUnrollCount, MaxUnroll,
+					      UseProfile, TripCount);
 
     LLVM_DEBUG(dbgs() << "Trying to unroll loop by " << UnrollCount << "... ");
 
@@ -47,9 +190,6 @@ void UnrollLoops(Pass &P, Function &F, unsigned DefaultUnrollCount, unsigned Max
       TripMult = UnrollCount;
 
     // Actually unroll loop
-    DominatorTree &DomTree = P.getAnalysis<DominatorTreeWrapperPass>(F).getDomTree();
-    AssumptionCache &AssC = P.getAnalysis<AssumptionCacheTracker>().getAssumptionCache(F);
-    OptimizationRemarkEmitter &ORE = P.getAnalysis<OptimizationRemarkEmitterWrapperPass>(F).getORE();
     UnrollLoopOptions ULO = {
       .Count = UnrollCount,
       .TripCount = TripCount,
@@ -64,7 +204,7 @@ void UnrollLoops(Pass &P, Function &F, unsigned DefaultUnrollCount, unsigned Max
       .ForgetAllSCEV = false
     };
 
-    LoopUnrollResult URes = UnrollLoop(L, ULO, &LInfo, &SE, &DomTree, &AssC, &ORE, false);
+    LoopUnrollResult URes = UnrollLoop(L, ULO, &LInfo, &SE, &LA.DT, &AssC, &ORE, false);
 
     switch (URes) {
       case LoopUnrollResult::Unmodified:
@@ -72,12 +212,19 @@ void UnrollLoops(Pass &P, Function &F, unsigned DefaultUnrollCount, unsigned Max
     	break;
       case LoopUnrollResult::PartiallyUnrolled:
     	LLVM_DEBUG(dbgs() << "unrolled partially.\n");
+	Changed = true;
     	break;
       case LoopUnrollResult::FullyUnrolled:
     	LLVM_DEBUG(dbgs() << "done.\n");
+	Changed = true;
     	break;
     }
+    if (URes != LoopUnrollResult::Unmodified) {
+      ++NumUnrolledLoops;
+      NumUnrolledIterations += UnrollCount;
+    }
   }
+  return Changed;
 }
 
 FunctionCopyCount *FunctionCopyManager::prepareFunctionData(Function *F) {
@@ -85,34 +232,139 @@ FunctionCopyCount *FunctionCopyManager::prepareFunctionData(Function *F) {
 
   auto FCData = FCMap.find(F);
   if (FCData == FCMap.end()) {
-    // If no copy of F has already been made, create one, so loop transformations
-    // do not change original code.
     FunctionCopyCount &FCC = FCMap[F];
 
     if ((FCC.MaxRecCount = mdutils::MetadataManager::retrieveMaxRecursionCount(*F)) == 0U)
       FCC.MaxRecCount = MaxRecursionCount;
 
-    // Check if we really need to clone the function
-    if (MaxUnroll > 0U && !F->empty()) {
-      LoopInfo &LInfo =
-	P.getAnalysis<LoopInfoWrapperPass>(*F).getLoopInfo();
-      if (!LInfo.empty()) {
-	FCC.Copy = CloneFunction(F, FCC.VMap);
-
-	if (FCC.Copy != nullptr)
-	  UnrollLoops(P, *FCC.Copy, DefaultUnrollCount, MaxUnroll);
-      }
-    }
     return &FCC;
   }
   return &FCData->second;
 }
 
-FunctionCopyManager::~FunctionCopyManager() {
-  for (auto &FCC : FCMap) {
-    if (FCC.second.Copy != nullptr)
-      FCC.second.Copy->eraseFromParent();
+void FunctionCopyManager::materializeCopy(Function *F, FunctionCopyCount &FCC) {
+  assert(FCC.Copy == nullptr);
+
+  // Check if we really need to clone the function
+  if (MaxUnroll == 0U || F->empty()
+      || (Ctx.Slice != nullptr && !Ctx.Slice->reaches(F))) {
+    FCC.NeedsCopy = false;
+    return;
+  }
+
+  TargetLibraryInfo &TLI = P.getAnalysis<TargetLibraryInfoWrapperPass>().getTLI(*F);
+  AssumptionCache &AssC = P.getAnalysis<AssumptionCacheTracker>().getAssumptionCache(*F);
+  LoopAnalyses LA(*F, TLI, AssC);
+  LoopInfo &LInfo = LA.LI;
+  ScalarEvolution &SE = LA.SE;
+  // Headers of the loops worth unrolling.
+  SmallPtrSet<const BasicBlock *, 4U> Headers;
+  for (Loop *L : LInfo) {
+    if ((PruneLoops && !isLoopRelevant(L))
+	|| (Ctx.Slice != nullptr && !Ctx.Slice->containsLoop(L))) {
+      LLVM_DEBUG(dbgs() << "[taffo-err] Loop " << L->getHeader()->getName()
+		 << " cannot affect errors, not unrolling.\n");
+      continue;
+    }
+
+    unsigned TripCount;
+    unsigned UnrollCount = computeUnrollCount(SE, LInfo, L,
+					      DefaultUnrollCount, MaxUnroll,
+					      UseProfile, TripCount);
+    if (mayUnrollLoop(L, UnrollCount, TripCount))
+      Headers.insert(L->getHeader());
+  }
+  if (Headers.empty()) {
+    LLVM_DEBUG(dbgs() << "[taffo-err] No loop to unroll in " << F->getName() << ", not cloning.\n");
+    FCC.NeedsCopy = false;
+    return;
+  }
+
+  // Create a copy of F, so loop transformations do not change original code.
+  {
+    PhaseTimer T("clone", "Function cloning");
+    FCC.Copy = CloneFunction(F, FCC.VMap);
+  }
+  if (FCC.Copy == nullptr)
+    return;
+  ++NumClones;
+
+  // Map the selected headers to the copy.
+  SmallPtrSet<const BasicBlock *, 4U> CopyHeaders;
+  for (const BasicBlock *H : Headers) {
+    Value *CopyH = FCC.VMap[H];
+    CopyHeaders.insert(cast<BasicBlock>(CopyH));
+  }
+
+  bool Unrolled;
+  {
+    PhaseTimer T("unroll", "Loop unrolling");
+    Unrolled = UnrollLoops(P, *FCC.Copy, DefaultUnrollCount, MaxUnroll,
+			   UseProfile, &CopyHeaders);
   }
+  if (!Unrolled) {
+    // No loop has been actually unrolled: the original function will do.
+    LLVM_DEBUG(dbgs() << "[taffo-err] Loops of " << F->getName() << " left unmodified, dropping copy.\n");
+    dropCopy(FCC);
+    FCC.NeedsCopy = false;
+    return;
+  }
+
+  // Values of the copy point to the same objects as the original ones.
+  if (Ctx.PTA != nullptr)
+    Ctx.PTA->addClone(FCC.VMap);
+
+  FCC.CopyBytes = estimateCopyBytes(*FCC.Copy);
+  if (Ctx.Telemetry != nullptr)
+    Ctx.Telemetry->addFunctionCopy(FCC.CopyBytes);
+}
+
+void FunctionCopyManager::reuseCopy(FunctionCopyCount &FCC) {
+  assert(FCC.Copy != nullptr && FCC.RefCount == 1U);
+  IdleCopies.erase(FCC.IdlePos);
+  IdleBytes -= FCC.CopyBytes;
+  ++NumReusedClones;
+}
+
+void FunctionCopyManager::releaseFunctionCopy(Function *F) {
+  auto FCData = FCMap.find(F);
+  if (FCData == FCMap.end())
+    return;
+
+  FunctionCopyCount &FCC = FCData->second;
+  assert(FCC.RefCount > 0U && "Unbalanced function copy release.");
+  if (--FCC.RefCount > 0U || FCC.Copy == nullptr)
+    return;
+
+  // Keep the copy, so that later calls need not clone and unroll F again.
+  FCC.IdlePos = IdleCopies.insert(IdleCopies.end(), F);
+  IdleBytes += FCC.CopyBytes;
+  while (IdleBytes > MaxIdleBytes) {
+    FunctionCopyCount &Oldest = FCMap[IdleCopies.front()];
+    LLVM_DEBUG(dbgs() << "[taffo-err] Dropping copy of "
+	       << IdleCopies.front()->getName() << ".\n");
+    IdleCopies.pop_front();
+    IdleBytes -= Oldest.CopyBytes;
+    dropCopy(Oldest);
+  }
+}
+
+void FunctionCopyManager::dropCopy(FunctionCopyCount &FCC) {
+  FCC.VMap.clear();
+  if (FCC.Copy != nullptr) {
+    if (Ctx.PTA != nullptr)
+      Ctx.PTA->removeClone(*FCC.Copy);
+    if (Ctx.Telemetry != nullptr && FCC.CopyBytes != 0U)
+      Ctx.Telemetry->removeFunctionCopy(FCC.CopyBytes);
+    FCC.CopyBytes = 0U;
+    FCC.Copy->eraseFromParent();
+    FCC.Copy = nullptr;
+  }
+}
+
+FunctionCopyManager::~FunctionCopyManager() {
+  for (auto &FCC : FCMap)
+    dropCopy(FCC.second);
 }
 
 } // end namespace ErrorProp
@@ -18,8 +18,12 @@
 
 #include "llvm/Transforms/Utils/Cloning.h"
 #include "llvm/IR/Function.h"
+#include "llvm/ADT/SmallPtrSet.h"
+#include <list>
 #include <map>
 
+#include "AnalysisContext.h"
+
 namespace ErrorProp {
 
 struct FunctionCopyCount {
@@ -27,29 +31,69 @@ struct FunctionCopyCount {
   llvm::ValueToValueMapTy VMap;
   unsigned RecCount = 0U;
   unsigned MaxRecCount = 1U;
+  /// Number of function propagators currently using Copy.
+  unsigned RefCount = 0U;
+  /// False if cloning this function is useless,
+  /// because none of its loops can be unrolled.
+  bool NeedsCopy = true;
+  /// Estimated size of Copy.
+  size_t CopyBytes = 0U;
+  /// Position of Copy among the unused copies, if RefCount is 0.
+  std::list<llvm::Function *>::iterator IdlePos;
 };
 
-void UnrollLoops(llvm::Pass &P, llvm::Function &F, unsigned DefaultUnrollCount, unsigned MaxUnroll);
-
+/// Unroll all top-level loops of F.
+/// If UseProfile is true, trip counts estimated from branch weights are used
+/// for loops whose trip count is unknown.
+/// If Headers is not null, only loops whose header is contained in it are unrolled.
+/// Returns true if at least one loop has been modified.
+bool UnrollLoops(llvm::Pass &P, llvm::Function &F, unsigned DefaultUnrollCount, unsigned MaxUnroll,
+		 bool UseProfile = false,
+		 const llvm::SmallPtrSetImpl<const llvm::BasicBlock *> *Headers = nullptr);
+
+/// Creates and keeps track of the unrolled copies of functions.
+/// The slice in Ctx restricts cloning and unrolling, and its points-to data
+/// and telemetry are kept up to date with the copies.
 class FunctionCopyManager {
 public:
 
   FunctionCopyManager(llvm::Pass &P,
+		      const AnalysisContext &Ctx,
 		      unsigned MaxRecursionCount,
 		      unsigned DefaultUnrollCount,
-		      unsigned MaxUnroll)
+		      unsigned MaxUnroll,
+		      bool PruneLoops = true,
+		      bool UseProfile = false,
+		      size_t MaxIdleBytes = 0U)
     : P(P),
+      Ctx(Ctx),
       MaxRecursionCount(MaxRecursionCount),
       MaxUnroll(MaxUnroll),
-      DefaultUnrollCount(DefaultUnrollCount) {}
-
-  llvm::Function *getFunctionCopy(llvm::Function *F) {
+      DefaultUnrollCount(DefaultUnrollCount),
+      PruneLoops(PruneLoops),
+      UseProfile(UseProfile),
+      MaxIdleBytes(MaxIdleBytes),
+      IdleBytes(0U) {}
+
+  /// Get the unrolled copy of F, cloning it if it is not alive.
+  /// Returns nullptr if F does not need to be cloned.
+  /// Each call must be matched by a call to releaseFunctionCopy.
+  llvm::Function *acquireFunctionCopy(llvm::Function *F) {
     FunctionCopyCount *FCData = prepareFunctionData(F);
     assert(FCData != nullptr);
 
+    if (FCData->RefCount++ == 0U && FCData->Copy != nullptr)
+      reuseCopy(*FCData);
+    if (FCData->Copy == nullptr && FCData->NeedsCopy)
+      materializeCopy(F, *FCData);
+
     return FCData->Copy;
   }
 
+  /// Keep the copy of F for later calls when no one is using it anymore,
+  /// dropping the least recently used copies exceeding MaxIdleBytes.
+  void releaseFunctionCopy(llvm::Function *F);
+
   unsigned getRecursionCount(llvm::Function *F) {
     auto FCData = FCMap.find(F);
     if (FCData == FCMap.end())
@@ -107,11 +151,22 @@ protected:
   FunctionCopyMap FCMap;
 
   llvm::Pass &P;
+  const AnalysisContext &Ctx;
   unsigned MaxRecursionCount;
   unsigned DefaultUnrollCount;
   unsigned MaxUnroll;
+  bool PruneLoops;
+  bool UseProfile;
+  /// Largest size of the copies kept while not in use.
+  size_t MaxIdleBytes;
+  size_t IdleBytes;
+  /// Originals of the copies not in use, least recently used first.
+  std::list<llvm::Function *> IdleCopies;
 
   FunctionCopyCount *prepareFunctionData(llvm::Function *F);
+  void materializeCopy(llvm::Function *F, FunctionCopyCount &FCC);
+  void reuseCopy(FunctionCopyCount &FCC);
+  void dropCopy(FunctionCopyCount &FCC);
 };
 
 } // end namespace ErrorProp
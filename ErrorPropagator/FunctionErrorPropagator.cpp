@@ -14,9 +14,15 @@
 
 #include "FunctionErrorPropagator.h"
 
+#include <algorithm>
+#include <functional>
+
 #include "llvm/IR/InstIterator.h"
+#include "llvm/IR/IntrinsicInst.h"
 #include "llvm/IR/CallSite.h"
 #include "llvm/Support/Debug.h"
+#include "llvm/Support/Error.h"
+#include "llvm/ADT/Statistic.h"
 #include "llvm/Analysis/CFLSteensAliasAnalysis.h"
 #include "llvm/Analysis/LoopInfo.h"
 
@@ -24,6 +30,7 @@
 #include "MemSSAUtils.h"
 #include "Metadata.h"
 #include "TypeUtils.h"
+#include "PhaseTimer.h"
 
 namespace ErrorProp {
 
@@ -32,6 +39,16 @@ using namespace mdutils;
 
 #define DEBUG_TYPE "errorprop"
 
+STATISTIC(NumPropagated, "Number of instructions whose error has been computed");
+STATISTIC(NumInitialErrors, "Number of instructions with the error in metadata");
+STATISTIC(NumNoError, "Number of instructions left without error");
+STATISTIC(NumUnhandled, "Number of instructions without error because of their kind");
+STATISTIC(NumSkippedSparse, "Number of instructions skipped by -sparse");
+STATISTIC(NumSkippedSlice, "Number of instructions skipped by -targetonly");
+STATISTIC(NumCallsAnalyzed, "Number of calls whose callee has been analyzed");
+STATISTIC(NumCallsMaxRecursion, "Number of calls not analyzed because of the recursion limit");
+STATISTIC(MaxNoiseTerms, "Maximum number of noise terms in an error");
+
 void
 FunctionErrorPropagator::computeErrorsWithCopy(RangeErrorMap &GlobRMap,
 					       SmallVectorImpl<Value *> *Args,
@@ -43,6 +60,7 @@ FunctionErrorPropagator::computeErrorsWithCopy(RangeErrorMap &GlobRMap,
 
   // Increase count of consecutive recursive calls.
   unsigned OldRecCount = FCMap.incRecursionCount(&F);
+  FunctionProfiler::Scope Prof(Ctx.Profiler, F, OldRecCount + 1);
 
   Function &CF = *FCopy;
 
@@ -53,13 +71,14 @@ FunctionErrorPropagator::computeErrorsWithCopy(RangeErrorMap &GlobRMap,
   RMap = GlobRMap;
   // Reset the error associated to this function.
   RMap.erase(FCopy);
+  ErrorTelemetry::Scope Tel(Ctx.Telemetry, RMap);
 
   // CFLSteensAAWrapperPass *CFLSAA =
   //   EPPass.getAnalysisIfAvailable<CFLSteensAAWrapperPass>();
   // if (CFLSAA != nullptr)
   //   CFLSAA->getResult().scan(FCopy);
 
-  MemSSA = &(EPPass.getAnalysis<MemorySSAWrapperPass>(CF).getMSSA());
+  restoreMemorySSA();
 
   computeFunctionErrors(Args);
 
@@ -70,6 +89,9 @@ FunctionErrorPropagator::computeErrorsWithCopy(RangeErrorMap &GlobRMap,
 
   applyActualParametersErrors(GlobRMap, Args);
 
+  // Errors stored through pointers are seen by the caller.
+  GlobRMap.updateObjectErrors(RMap);
+
   // Associate computed errors to global variables.
   for (const GlobalVariable &GV : F.getParent()->globals()) {
     const AffineForm<inter_t> *GVErr = RMap.getError(&GV);
@@ -99,7 +121,10 @@ FunctionErrorPropagator::computeFunctionErrors(SmallVectorImpl<Value *> *ArgErrs
   if (ArgErrs)
     RMap.initArgumentBindings(*FCopy, *ArgErrs);
 
-  RMap.retrieveRangeErrors(*FCopy);
+  {
+    PhaseTimer T("mdretrieve", "Metadata retrieval");
+    RMap.retrieveRangeErrors(*FCopy);
+  }
   RMap.applyArgumentErrors(*FCopy, ArgErrs);
 
   LoopInfo &LInfo =
@@ -109,17 +134,136 @@ FunctionErrorPropagator::computeFunctionErrors(SmallVectorImpl<Value *> *ArgErrs
   BBScheduler BBSched(*FCopy, LInfo);
 
   // Restore MemSSA
-  assert(FCopy != nullptr);
-  MemSSA = &(EPPass.getAnalysis<MemorySSAWrapperPass>(*FCopy).getMSSA());
+  restoreMemorySSA();
+
+  const TargetSlice *Slice = Ctx.Slice;
+  if (!Sparse && Slice == nullptr) {
+    for (BasicBlock *BB : BBSched)
+      for (Instruction &I : *BB)
+	computeInstructionErrors(I);
+    return;
+  }
+
+  DenseSet<const Instruction *> SparseInsts;
+  if (Sparse) {
+    findSparseInstructions(SparseInsts);
+    LLVM_DEBUG(dbgs() << "[taffo-err] Sparse mode: processing " << SparseInsts.size()
+	       << " instructions.\n");
+  }
+
+  // Map instructions of the copy back to the original function,
+  // which is where the slice has been computed.
+  DenseMap<const Value *, const Value *> CopyToOrig;
+  if (Slice != nullptr && FCopy != &F) {
+    ValueToValueMapTy *VMap = FCMap.getValueToValueMap(&F);
+    assert(VMap != nullptr);
+    for (const auto &VV : *VMap) {
+      const Value *CV = VV.second;
+      if (CV != nullptr)
+	CopyToOrig[CV] = VV.first;
+    }
+  }
 
   for (BasicBlock *BB : BBSched)
-    for (Instruction &I : *BB)
+    for (Instruction &I : *BB) {
+      if (Sparse && !SparseInsts.count(&I)) {
+	++NumSkippedSparse;
+	continue;
+      }
+      if (Slice != nullptr) {
+	const Value *Orig = (FCopy == &F) ? &I : CopyToOrig.lookup(&I);
+	// Instructions created by unrolling are not mapped, keep them.
+	if (Orig != nullptr && !Slice->isRelevant(*cast<Instruction>(Orig))) {
+	  ++NumSkippedSlice;
+	  continue;
+	}
+      }
       computeInstructionErrors(I);
+    }
+}
+
+void
+FunctionErrorPropagator::findSparseInstructions(DenseSet<const Instruction *> &Insts) {
+  assert(FCopy != nullptr && MemSSA != nullptr);
+
+  SmallVector<const Instruction *, 32U> Worklist;
+  auto Enqueue = [&](const Instruction *I) {
+    if (I->getFunction() == FCopy && Insts.insert(I).second)
+      Worklist.push_back(I);
+  };
+  // Enqueue instructions using V, looking through constant expressions.
+  std::function<void(const Value *)> EnqueueUsers = [&](const Value *V) {
+    for (const User *U : V->users()) {
+      if (const Instruction *UI = dyn_cast<Instruction>(U))
+	Enqueue(UI);
+      else if (isa<ConstantExpr>(U))
+	EnqueueUsers(U);
+    }
+  };
+
+  // Seeds: formal parameters and global variables with ranges or errors,
+  // instructions with range or struct metadata, and calls to functions
+  // with a body (which may hold targets or store through pointers)
+  // or with arguments that have ranges or errors.
+  MetadataManager &MDManager = RMap.getMetadataManager();
+  for (const Argument &Arg : FCopy->args())
+    if (RMap.getRangeError(&Arg) != nullptr)
+      EnqueueUsers(&Arg);
+  for (const GlobalVariable &GV : F.getParent()->globals())
+    if (RMap.getRangeError(&GV) != nullptr
+	|| MDManager.retrieveStructInfo(GV) != nullptr)
+      EnqueueUsers(&GV);
+  for (const Instruction &I : instructions(*FCopy)) {
+    const InputInfo *II = MDManager.retrieveInputInfo(I);
+    if ((II != nullptr && II->IRange != nullptr)
+	|| MDManager.retrieveStructInfo(I) != nullptr)
+      Enqueue(&I);
+    else if (ImmutableCallSite CS = ImmutableCallSite(&I)) {
+      const Function *Callee = CS.getCalledFunction();
+      if (Callee != nullptr && !Callee->isDeclaration())
+	Enqueue(&I);
+      else if (std::any_of(CS.arg_begin(), CS.arg_end(), [this](const Value *Arg) {
+	    return RMap.getRangeError(Arg) != nullptr;
+	  }))
+	Enqueue(&I);
+    }
+  }
+
+  SmallPtrSet<const MemoryPhi *, 8U> VisitedPhis;
+  SmallVector<const MemoryAccess *, 8U> MAWorklist;
+  while (!Worklist.empty()) {
+    const Instruction *I = Worklist.pop_back_val();
+    EnqueueUsers(I);
+
+    // Follow MemorySSA def-use edges from memory definitions.
+    const MemoryUseOrDef *MA = MemSSA->getMemoryAccess(I);
+    if (MA == nullptr || !isa<MemoryDef>(MA))
+      continue;
+
+    MAWorklist.push_back(MA);
+    while (!MAWorklist.empty()) {
+      const MemoryAccess *Def = MAWorklist.pop_back_val();
+      for (const User *U : Def->users()) {
+	if (const MemoryUseOrDef *UseOrDef = dyn_cast<MemoryUseOrDef>(U)) {
+	  if (Instruction *MI = UseOrDef->getMemoryInst())
+	    Enqueue(MI);
+	}
+	else if (const MemoryPhi *MPhi = dyn_cast<MemoryPhi>(U)) {
+	  if (VisitedPhis.insert(MPhi).second)
+	    MAWorklist.push_back(MPhi);
+	}
+      }
+    }
+  }
 }
 
 void
 FunctionErrorPropagator::computeInstructionErrors(Instruction &I) {
-  bool HasInitialError = RMap.retrieveRangeError(I);
+  bool HasInitialError;
+  {
+    PhaseTimer T("mdretrieve", "Metadata retrieval");
+    HasInitialError = RMap.retrieveRangeError(I);
+  }
 
   double InitialError;
   if (HasInitialError) {
@@ -129,6 +273,21 @@ FunctionErrorPropagator::computeInstructionErrors(Instruction &I) {
   }
 
   bool ComputedError = dispatchInstruction(I);
+  const AffineForm<inter_t> *Err = ComputedError ? RMap.getError(&I) : nullptr;
+  size_t NumNoiseTerms = (Err != nullptr) ? Err->getNumNoiseTerms() : 0U;
+  if (FunctionProfiler *Prof = Ctx.Profiler)
+    Prof->visitInstruction(NumNoiseTerms);
+  if (ComputedError) {
+    ++NumPropagated;
+    MaxNoiseTerms.updateMax(NumNoiseTerms);
+    ErrorTelemetry *Tel = Ctx.Telemetry;
+    if (Tel != nullptr && Err != nullptr)
+      Tel->recordError(I, F, NumNoiseTerms);
+  }
+  else if (HasInitialError)
+    ++NumInitialErrors;
+  else
+    ++NumNoError;
 
   // if (HasInitialError) {
   //   if (ComputedError) {
@@ -161,7 +320,15 @@ bool
 FunctionErrorPropagator::dispatchInstruction(Instruction &I) {
   assert(MemSSA != nullptr);
 
-  InstructionPropagator IP(RMap, *MemSSA, SloppyAA);
+  // Callees are analyzed first, and timed on their own.
+  // This recomputes MemSSA, so IP must be built afterwards.
+  if (isa<CallInst>(I) || isa<InvokeInst>(I))
+    prepareErrorsForCall(I);
+
+  InstructionPropagator IP(RMap, *MemSSA, Ctx.PTA, &ClobberCache, &Origins,
+			   Ctx.Summaries);
+
+  PhaseTimer T(I);
 
   if (I.isBinaryOp())
     return IP.propagateBinaryOp(I);
@@ -196,7 +363,6 @@ FunctionErrorPropagator::dispatchInstruction(Instruction &I) {
     case Instruction::Call:
      // Fall-through.
     case Instruction::Invoke:
-      prepareErrorsForCall(I);
       return IP.propagateCall(I);
     case Instruction::UIToFP:
       // Fall-through.
@@ -206,9 +372,16 @@ FunctionErrorPropagator::dispatchInstruction(Instruction &I) {
       // Fall-through.
     case Instruction::FPToSI:
       return IP.propagateFPToI(I);
+    case Instruction::ExtractElement:
+      return IP.propagateExtractElement(I);
+    case Instruction::InsertElement:
+      return IP.propagateInsertElement(I);
+    case Instruction::ShuffleVector:
+      return IP.propagateShuffleVector(I);
     default:
       LLVM_DEBUG(InstructionPropagator::logInstruction(I);
 		 InstructionPropagator::logInfoln("unhandled."));
+      ++NumUnhandled;
       return false;
   }
   llvm_unreachable("No return statement.");
@@ -227,7 +400,7 @@ FunctionErrorPropagator::prepareErrorsForCall(Instruction &I) {
       if (RE != nullptr && RE->second.hasValue())
 	Args.push_back(Arg);
       else {
-	Value *OrigPointer = MemSSAUtils::getOriginPointer(*MemSSA, Arg);
+	Value *OrigPointer = Origins.getOriginPointer(Arg);
 	Args.push_back(OrigPointer);
       }
     }
@@ -236,25 +409,62 @@ FunctionErrorPropagator::prepareErrorsForCall(Instruction &I) {
     }
   }
 
-  if (CalledF == nullptr
-      || InstructionPropagator::isSpecialFunction(*CalledF))
+  if (CalledF == nullptr || CalledF->isIntrinsic()
+      || InstructionPropagator::isSpecialFunction(*CalledF)
+      || InstructionPropagator::isFMA(*CalledF))
+    return;
+
+  // Summarized functions are not analyzed again.
+  const ErrorSummaryDB *Summaries = Ctx.Summaries;
+  if (Summaries != nullptr && Summaries->getSummaryForCall(I, RMap) != nullptr)
+    return;
+
+  // Skip functions that cannot affect any target.
+  const TargetSlice *Slice = Ctx.Slice;
+  if (Slice != nullptr && !Slice->reaches(CalledF))
     return;
 
   LLVM_DEBUG(dbgs() << "[taffo-err] Preparing errors for function call/invoke "
 	<< I.getName() << "...\n");
 
+  // Callees may have been left unloaded because they have a summary
+  // (cf. taffo-errprop), which does not cover this call.
+  if (CalledF->isMaterializable()) {
+    if (Error Err = CalledF->materialize()) {
+      logAllUnhandledErrors(std::move(Err), dbgs(),
+			    "[taffo-err] WARNING: cannot load " + CalledF->getName() + ": ");
+      return;
+    }
+  }
+
   // Stop if we have reached the maximum recursion count.
-  if (FCMap.maxRecursionCountReached(CalledF))
+  if (FCMap.maxRecursionCountReached(CalledF)) {
+    ++NumCallsMaxRecursion;
     return;
+  }
 
   // Now propagate the errors for this call.
+  PhaseTimer T("interprocedural", "Callee analysis (inclusive)");
+  ++NumCallsAnalyzed;
+  if (ErrorTelemetry *Tel = Ctx.Telemetry)
+    Tel->sampleMaps();
   FunctionErrorPropagator CFEP(EPPass, *CalledF,
-			       FCMap, RMap.getMetadataManager(), SloppyAA);
+			       FCMap, RMap.getMetadataManager(), Ctx, Sparse);
   CFEP.computeErrorsWithCopy(RMap, &Args, false);
 
   // Restore MemorySSA
+  restoreMemorySSA();
+}
+
+void
+FunctionErrorPropagator::restoreMemorySSA() {
   assert(FCopy != nullptr);
+  PhaseTimer T("memssa", "MemorySSA construction");
   MemSSA = &(EPPass.getAnalysis<MemorySSAWrapperPass>(*FCopy).getMSSA());
+  // Cached clobbers refer to the accesses of the previous MemorySSA,
+  // while pointer origins only depend on FCopy, which has not changed.
+  ClobberCache.reset(MemSSA);
+  Origins.setMemorySSA(MemSSA);
 }
 
 void
@@ -276,7 +486,7 @@ FunctionErrorPropagator::applyActualParametersErrors(RangeErrorMap &GlobRMap,
 
     const AffineForm<inter_t> *Err = RMap.getError(&(*FArg));
     if (Err == nullptr) {
-      Value *OrigPointer = MemSSAUtils::getOriginPointer(*MemSSA, &*FArg);
+      Value *OrigPointer = Origins.getOriginPointer(&*FArg);
       Err = RMap.getError(OrigPointer);
       if (Err == nullptr)
 	continue;
@@ -293,8 +503,13 @@ FunctionErrorPropagator::applyActualParametersErrors(RangeErrorMap &GlobRMap,
 
 void
 FunctionErrorPropagator::attachErrorMetadata() {
+  PhaseTimer T("mdattach", "Metadata attachment");
   ValueToValueMapTy *VMap = FCMap.getValueToValueMap(&F);
   assert(VMap != nullptr);
+  ErrorReport *Report = Ctx.Report;
+  ErrorMetadataEmitter *MDEmitter = Ctx.MDEmitter;
+  if (MDEmitter)
+    MDEmitter->beginFunction(F);
 
   for (inst_iterator I = inst_begin(F), E = inst_end(F); I != E; ++I) {
     Value *InstCopy = (Cloned) ? (*VMap)[cast<Value>(&*I)] : &*I;
@@ -303,13 +518,24 @@ FunctionErrorPropagator::attachErrorMetadata() {
 
     double Error = RMap.getOutputError(InstCopy);
     if (!std::isnan(Error)) {
-      MetadataManager::setErrorMetadata(*I, Error);
+      if (MDEmitter)
+	MDEmitter->emitError(*I, Error);
+      else
+	MetadataManager::setErrorMetadata(*I, Error);
+      if (Report)
+	Report->recordError(*I, Error);
     }
 
     CmpErrorMap::const_iterator CmpErr = CmpMap.find(InstCopy);
-    if (CmpErr != CmpMap.end())
+    if (CmpErr != CmpMap.end()) {
       MetadataManager::setCmpErrorMetadata(*I, CmpErr->second);
+      if (Report)
+	Report->recordCmp(*I, CmpErr->second);
+    }
   }
+
+  if (MDEmitter)
+    MDEmitter->endFunction();
 }
 
 bool FunctionErrorPropagator::checkOverflow(Instruction &I) {
@@ -323,49 +549,83 @@ bool FunctionErrorPropagator::checkOverflow(Instruction &I) {
     || Range->Max > Type->getMaxValueBound();
 }
 
-void BBScheduler::enqueueChildren(BasicBlock *BB) {
+bool BBScheduler::markVisited(BasicBlock *BB) {
   assert(BB != nullptr && "Null basic block.");
-
   // Do nothing if already visited.
-  if (Set.count(BB))
+  return Visited.insert(BB).second;
+}
+
+void BBScheduler::enqueueChildren(BasicBlock *BB) {
+  if (!markVisited(BB))
     return;
 
-  LLVM_DEBUG(dbgs() << "[taffo-err] Scheduling " << BB->getName() << ".\n");
+  std::vector<Frame> Stack;
+  Stack.push_back(Frame{BB, {}, 0U});
+  prepareFrame(Stack.back());
+
+  while (!Stack.empty()) {
+    Frame &Top = Stack.back();
+    if (Top.Next >= Top.Items.size()) {
+      // All successors have been visited.
+      Queue.push_back(Top.BB);
+      Stack.pop_back();
+      continue;
+    }
+
+    auto Item = Top.Items[Top.Next++];
+    BasicBlock *Succ = Item.getPointer();
+    if (Item.getInt()) {
+      // Loop header visited also after the loop body.
+      Queue.push_back(Succ);
+      continue;
+    }
+
+    if (!markVisited(Succ))
+      continue;
+
+    // Top is invalidated here.
+    Stack.push_back(Frame{Succ, {}, 0U});
+    prepareFrame(Stack.back());
+  }
+}
+
+void BBScheduler::prepareFrame(Frame &BBFrame) const {
+  BasicBlock *BB = BBFrame.BB;
 
-  Set.insert(BB);
+  LLVM_DEBUG(dbgs() << "[taffo-err] Scheduling " << BB->getName() << ".\n");
 
   Instruction *TI = BB->getTerminator();
-  if (TI != nullptr) {
-    Loop *L = LInfo.getLoopFor(BB);
-    if (L == nullptr) {
-      // Not part of a loop, just visit all unvisited successors.
-      int c = TI->getNumSuccessors();
-      for (int i=0; i<c; i++)
-        enqueueChildren(TI->getSuccessor(i));
+  if (TI == nullptr)
+    return;
+
+  Loop *L = LInfo.getLoopFor(BB);
+  if (L == nullptr) {
+    // Not part of a loop, just visit all unvisited successors.
+    int c = TI->getNumSuccessors();
+    for (int i=0; i<c; i++)
+      BBFrame.Items.push_back({TI->getSuccessor(i), false});
+  }
+  else {
+    // Part of a loop:
+    // visit exiting blocks first, so they are scheduled at the end.
+    SmallVector<BasicBlock *, 2U> BodyQueue;
+    int c = TI->getNumSuccessors();
+    for (int i=0; i<c; i++) {
+      BasicBlock *DestBB = TI->getSuccessor(i);
+      if (isExiting(DestBB, L))
+	BBFrame.Items.push_back({DestBB, false});
+      else
+	BodyQueue.push_back(DestBB);
     }
-    else {
-      // Part of a loop:
-      // visit exiting blocks first, so they are scheduled at the end.
-      SmallVector<BasicBlock *, 2U> BodyQueue;
-      int c = TI->getNumSuccessors();
-      for (int i=0; i<c; i++) {
-        BasicBlock *DestBB = TI->getSuccessor(i);
-	if (isExiting(DestBB, L))
-	  enqueueChildren(DestBB);
-	else
-	  BodyQueue.push_back(DestBB);
-      }
 
-      // If the header is also the exit, but not a latch,
-      // it is visited also after the loop body
-      if (L->isLoopExiting(BB) && !L->isLoopLatch(BB))
-	Queue.push_back(BB);
+    // If the header is also the exit, but not a latch,
+    // it is visited also after the loop body
+    if (L->isLoopExiting(BB) && !L->isLoopLatch(BB))
+      BBFrame.Items.push_back({BB, true});
 
-      for (BasicBlock *BodyBB : BodyQueue)
-	enqueueChildren(BodyBB);
-    }
+    for (BasicBlock *BodyBB : BodyQueue)
+      BBFrame.Items.push_back({BodyBB, false});
   }
-  Queue.push_back(BB);
 }
 
 bool BBScheduler::isExiting(BasicBlock *Dst, Loop *L) const {
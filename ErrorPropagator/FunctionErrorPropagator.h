@@ -17,13 +17,17 @@
 
 #include "RangeErrorMap.h"
 #include "FunctionCopyMap.h"
+#include "AnalysisContext.h"
+#include "MemSSAUtils.h"
 
 #include "llvm/Pass.h"
 #include "llvm/IR/Function.h"
 #include "llvm/IR/Instruction.h"
 #include "llvm/IR/BasicBlock.h"
 #include "llvm/ADT/SmallVector.h"
-#include "llvm/ADT/SmallSet.h"
+#include "llvm/ADT/DenseSet.h"
+#include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/ADT/PointerIntPair.h"
 #include <vector>
 #include "llvm/Analysis/MemorySSA.h"
 
@@ -36,15 +40,26 @@ public:
 			  llvm::Function &F,
 			  FunctionCopyManager &FCMap,
 			  mdutils::MetadataManager &MDManager,
-                          bool SloppyAA)
-    : EPPass(EPPass), F(F), FCMap(FCMap),
-      FCopy(FCMap.getFunctionCopy(&F)), RMap(MDManager),
+			  const AnalysisContext &Ctx,
+			  bool Sparse = false)
+    : EPPass(EPPass), F(F), FCMap(FCMap), Ctx(Ctx),
+      FCopy(FCMap.acquireFunctionCopy(&F)), RMap(MDManager),
       CmpMap(CMPERRORMAP_NUMINITBUCKETS), MemSSA(nullptr),
-      Cloned(true), SloppyAA(SloppyAA) {
+      Cloned(true), Sparse(Sparse) {
     if (FCopy == nullptr) {
       FCopy = &F;
       Cloned = false;
     }
+    Origins.reset(nullptr, FCopy);
+  }
+
+  FunctionErrorPropagator(const FunctionErrorPropagator &) = delete;
+  FunctionErrorPropagator &operator=(const FunctionErrorPropagator &) = delete;
+
+  /// Release the function copy, so it may be dropped
+  /// if no other propagator is working on it.
+  ~FunctionErrorPropagator() {
+    FCMap.releaseFunctionCopy(&F);
   }
 
   /// Propagate errors, cloning the function if code modifications are required.
@@ -63,6 +78,11 @@ protected:
   /// Compute errors instruction by instruction.
   void computeFunctionErrors(llvm::SmallVectorImpl<llvm::Value *> *ArgErrs);
 
+  /// Collect the instructions that may receive an error,
+  /// by following def-use chains and MemorySSA def-use edges
+  /// from the values that carry ranges or errors.
+  void findSparseInstructions(llvm::DenseSet<const llvm::Instruction *> &Insts);
+
   /// Compute errors for a single instruction,
   /// using the range from metadata attached to it.
   void computeInstructionErrors(llvm::Instruction &I);
@@ -78,6 +98,10 @@ protected:
   void applyActualParametersErrors(RangeErrorMap &GlobRMap,
 				   llvm::SmallVectorImpl<llvm::Value *> *Args);
 
+  /// Get MemorySSA for FCopy again, after other functions have been analyzed,
+  /// and drop the clobbers computed with the previous one.
+  void restoreMemorySSA();
+
   /// Attach error metadata to the original function.
   void attachErrorMetadata();
 
@@ -87,26 +111,34 @@ protected:
   llvm::Pass &EPPass;
   llvm::Function &F;
   FunctionCopyManager &FCMap;
+  /// Optional analyses and outputs, also passed to the analyses of callees.
+  const AnalysisContext &Ctx;
 
   llvm::Function *FCopy;
   RangeErrorMap RMap;
   CmpErrorMap CmpMap;
   llvm::MemorySSA *MemSSA;
+  /// Clobbers of the memory accesses in MemSSA.
+  MemSSAClobberCache ClobberCache;
+  /// Origins of the pointers in FCopy.
+  OriginPointerIndex Origins;
   bool Cloned;
-  bool SloppyAA;
+  bool Sparse;
 };
 
 /// Schedules basic blocks of a function so that all BBs
 /// that could be executed before another BB come before it in the ordering.
 /// This is a sort of topological ordering that takes loops into account.
+/// The visit is iterative, so it can handle very large CFGs.
 class BBScheduler {
 public:
   typedef std::vector<llvm::BasicBlock *> queue_type;
   typedef queue_type::reverse_iterator iterator;
 
   BBScheduler(llvm::Function &F, llvm::LoopInfo &LI)
-    : Queue(), Set(), LInfo(LI) {
+    : Queue(), Visited(), LInfo(LI) {
     Queue.reserve(F.size());
+    Visited.reserve(F.size());
     enqueueChildren(&F.getEntryBlock());
   }
 
@@ -123,12 +155,26 @@ public:
   }
 
 protected:
+  /// A block whose successors are being visited.
+  /// Items contains the successors to visit in order,
+  /// and the block itself (flagged) if it must be queued
+  /// before its remaining successors are visited.
+  struct Frame {
+    llvm::BasicBlock *BB;
+    llvm::SmallVector<llvm::PointerIntPair<llvm::BasicBlock *, 1U, bool>, 4U> Items;
+    unsigned Next;
+  };
+
   queue_type Queue;
-  llvm::SmallSet<llvm::BasicBlock *, 8U> Set;
+  llvm::SmallPtrSet<llvm::BasicBlock *, 32U> Visited;
   llvm::LoopInfo &LInfo;
 
+  /// Mark BB as visited. Returns false if it was already visited.
+  bool markVisited(llvm::BasicBlock *BB);
   /// Put BB and all of its successors in the queue.
   void enqueueChildren(llvm::BasicBlock *BB);
+  /// Fill in the successors of BBFrame.BB in visiting order.
+  void prepareFrame(Frame &BBFrame) const;
   /// True if Dst is an exiting or external block wrt Loop L.
   bool isExiting(llvm::BasicBlock *Dst, llvm::Loop *L) const;
 };
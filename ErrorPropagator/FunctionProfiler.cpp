@@ -0,0 +1,173 @@
+//===-- FunctionProfiler.cpp - Cost Profile of Function Analyses *- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// Records the cost of each (possibly nested) analysis of a function,
+/// and writes it as a table or as a Chrome trace-event timeline.
+///
+//===----------------------------------------------------------------------===//
+
+#include "FunctionProfiler.h"
+
+#include <algorithm>
+#include "llvm/ADT/StringMap.h"
+#include "llvm/Support/Debug.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/JSON.h"
+
+namespace ErrorProp {
+
+using namespace llvm;
+
+uint64_t FunctionProfiler::now() const {
+  return std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - Start)
+    .count();
+}
+
+void FunctionProfiler::enter(const Function &F, unsigned Recursion) {
+  Record R;
+  R.F = &F;
+  R.Name = F.getName().str();
+  R.Depth = Stack.size();
+  R.Recursion = Recursion;
+  R.StartUs = now();
+  R.DurationUs = 0U;
+  R.ChildrenUs = 0U;
+  R.Instructions = 0U;
+  R.PeakNoiseTerms = 0U;
+  R.Outermost = (Active[&F]++ == 0U);
+
+  Stack.push_back(Records.size());
+  Records.push_back(std::move(R));
+}
+
+void FunctionProfiler::exit() {
+  assert(!Stack.empty() && "Unbalanced function profile.");
+  Record &R = Records[Stack.back()];
+  R.DurationUs = now() - R.StartUs;
+  --Active[R.F];
+  Stack.pop_back();
+
+  if (!Stack.empty())
+    Records[Stack.back()].ChildrenUs += R.DurationUs;
+}
+
+void FunctionProfiler::visitInstruction(size_t NumNoiseTerms) {
+  if (Stack.empty())
+    return;
+
+  Record &R = Records[Stack.back()];
+  ++R.Instructions;
+  R.PeakNoiseTerms = std::max(R.PeakNoiseTerms, NumNoiseTerms);
+}
+
+void FunctionProfiler::printTable(raw_ostream &OS, unsigned N) const {
+  struct Totals {
+    StringRef Name;
+    uint64_t SelfUs = 0U;
+    uint64_t TotalUs = 0U;
+    unsigned Calls = 0U;
+    unsigned MaxDepth = 0U;
+    unsigned MaxRecursion = 0U;
+    uint64_t Instructions = 0U;
+    size_t PeakNoiseTerms = 0U;
+  };
+
+  StringMap<Totals> ByName;
+  for (const Record &R : Records) {
+    Totals &T = ByName[R.Name];
+    T.SelfUs += R.DurationUs - R.ChildrenUs;
+    // Nested analyses of the same function are already in the outermost one.
+    if (R.Outermost)
+      T.TotalUs += R.DurationUs;
+    ++T.Calls;
+    T.MaxDepth = std::max(T.MaxDepth, R.Depth);
+    T.MaxRecursion = std::max(T.MaxRecursion, R.Recursion);
+    T.Instructions += R.Instructions;
+    T.PeakNoiseTerms = std::max(T.PeakNoiseTerms, R.PeakNoiseTerms);
+  }
+
+  std::vector<Totals> Sorted;
+  for (auto &T : ByName) {
+    Sorted.push_back(T.second);
+    Sorted.back().Name = T.first();
+  }
+  std::sort(Sorted.begin(), Sorted.end(),
+	    [](const Totals &A, const Totals &B) {
+	      return (A.SelfUs != B.SelfUs) ? A.SelfUs > B.SelfUs : A.Name < B.Name;
+	    });
+
+  unsigned Shown = std::min<size_t>(N, Sorted.size());
+  OS << "Error propagation profile: top " << Shown << " of " << Sorted.size()
+     << " functions by self time, " << Records.size() << " analyses.\n";
+  OS << "  Self(ms)  Total(ms)    Calls  Depth    Rec     Instrs    Terms  Function\n";
+  for (unsigned Idx = 0U; Idx < Shown; ++Idx) {
+    const Totals &T = Sorted[Idx];
+    OS << format("%10.3f %10.3f %8u %6u %6u %10llu %8llu  ",
+		 T.SelfUs / 1000.0, T.TotalUs / 1000.0, T.Calls,
+		 T.MaxDepth, T.MaxRecursion,
+		 static_cast<unsigned long long>(T.Instructions),
+		 static_cast<unsigned long long>(T.PeakNoiseTerms))
+       << T.Name << "\n";
+  }
+}
+
+void FunctionProfiler::writeTrace(raw_ostream &OS) const {
+  json::OStream J(OS);
+  J.objectBegin();
+  J.attributeArray("traceEvents", [&] {
+    for (const Record &R : Records) {
+      J.object([&] {
+	J.attribute("name", R.Name);
+	J.attribute("cat", "errorprop");
+	J.attribute("ph", "X");
+	J.attribute("pid", 1);
+	J.attribute("tid", 1);
+	J.attribute("ts", static_cast<int64_t>(R.StartUs));
+	J.attribute("dur", static_cast<int64_t>(R.DurationUs));
+	J.attributeObject("args", [&] {
+	  J.attribute("depth", R.Depth);
+	  J.attribute("recursion", R.Recursion);
+	  J.attribute("instructions", R.Instructions);
+	  J.attribute("noiseterms", static_cast<int64_t>(R.PeakNoiseTerms));
+	});
+      });
+    }
+  });
+  J.attribute("displayTimeUnit", "ms");
+  J.objectEnd();
+  OS << "\n";
+}
+
+bool FunctionProfiler::writeTableFile(StringRef Path, unsigned N) const {
+  std::error_code EC;
+  raw_fd_ostream OS(Path, EC, sys::fs::OF_Text);
+  if (EC) {
+    dbgs() << "[taffo-err] WARNING: cannot write profile " << Path
+	   << ": " << EC.message() << ".\n";
+    return false;
+  }
+  printTable(OS, N);
+  return true;
+}
+
+bool FunctionProfiler::writeTraceFile(StringRef Path) const {
+  std::error_code EC;
+  raw_fd_ostream OS(Path, EC, sys::fs::OF_Text);
+  if (EC) {
+    dbgs() << "[taffo-err] WARNING: cannot write trace " << Path
+	   << ": " << EC.message() << ".\n";
+    return false;
+  }
+  writeTrace(OS);
+  return true;
+}
+
+} // end of namespace ErrorProp
@@ -0,0 +1,103 @@
+//===-- FunctionProfiler.h - Cost Profile of Function Analyses --*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// Records the cost of each (possibly nested) analysis of a function,
+/// and writes it as a table or as a Chrome trace-event timeline.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef ERRORPROPAGATOR_FUNCTION_PROFILER_H
+#define ERRORPROPAGATOR_FUNCTION_PROFILER_H
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/IR/Function.h"
+#include "llvm/Support/raw_ostream.h"
+
+namespace ErrorProp {
+
+class FunctionProfiler {
+public:
+  /// Profiles the analysis of a function while in scope.
+  /// Does nothing if the profiler is null.
+  class Scope {
+  public:
+    Scope(FunctionProfiler *P, const llvm::Function &F, unsigned Recursion)
+      : P(P) {
+      if (P)
+	P->enter(F, Recursion);
+    }
+    Scope(const Scope &) = delete;
+    Scope &operator=(const Scope &) = delete;
+    ~Scope() {
+      if (P)
+	P->exit();
+    }
+  private:
+    FunctionProfiler *P;
+  };
+
+  FunctionProfiler() : Start(Clock::now()) {}
+
+  /// Count an instruction visited by the innermost analysis,
+  /// whose error has NumNoiseTerms noise terms.
+  void visitInstruction(size_t NumNoiseTerms);
+
+  /// Print the N functions with the largest self time,
+  /// with their totals over all analyses.
+  void printTable(llvm::raw_ostream &OS, unsigned N) const;
+
+  /// Write all analyses as complete events in Chrome trace-event format.
+  void writeTrace(llvm::raw_ostream &OS) const;
+
+  bool writeTableFile(llvm::StringRef Path, unsigned N) const;
+  bool writeTraceFile(llvm::StringRef Path) const;
+
+private:
+  typedef std::chrono::steady_clock Clock;
+
+  /// One analysis of a function.
+  struct Record {
+    const llvm::Function *F;
+    std::string Name;
+    unsigned Depth;
+    unsigned Recursion;
+    /// Microseconds since the profiler was created.
+    uint64_t StartUs;
+    uint64_t DurationUs;
+    /// Time spent in nested analyses.
+    uint64_t ChildrenUs;
+    /// Instructions visited by this analysis, excluding nested ones.
+    unsigned Instructions;
+    /// Largest number of noise terms of an error computed by this analysis.
+    size_t PeakNoiseTerms;
+    /// True if no analysis of the same function encloses this one.
+    bool Outermost;
+  };
+
+  Clock::time_point Start;
+  std::vector<Record> Records;
+  /// Indices in Records of the analyses in progress.
+  std::vector<size_t> Stack;
+  /// Number of analyses in progress for each function.
+  llvm::DenseMap<const llvm::Function *, unsigned> Active;
+
+  uint64_t now() const;
+  void enter(const llvm::Function &F, unsigned Recursion);
+  void exit();
+};
+
+} // end of namespace ErrorProp
+
+#endif // ERRORPROPAGATOR_FUNCTION_PROFILER_H
@@ -1,9 +1,18 @@
 #include "MemSSAUtils.h"
 
+#include <algorithm>
+#include "llvm/ADT/PostOrderIterator.h"
+#include "llvm/ADT/Statistic.h"
+#include "llvm/IR/CFG.h"
+
 namespace ErrorProp {
 
 using namespace llvm;
 
+#define DEBUG_TYPE "errorprop"
+
+STATISTIC(NumMemSSAWalks, "Number of MemorySSA clobber walks");
+
 void MemSSAUtils::findLOEError(Instruction *I) {
   Value *Pointer;
   switch(I->getOpcode()) {
@@ -57,6 +66,15 @@ findMemSSAError(Instruction *I, MemoryAccess *MA) {
     return;
   }
 
+  if (Cache != nullptr) {
+    const MemSSAClobberCache::Clobbers &C = Cache->getClobbers(MA);
+    for (Instruction *Def : C.Defs)
+      Res.push_back(RMap.getRangeError(Def));
+    if (C.NeedsLOE)
+      findLOEError(I);
+    return;
+  }
+
   if (!Visited.insert(MA).second)
     return;
 
@@ -65,6 +83,7 @@ findMemSSAError(Instruction *I, MemoryAccess *MA) {
   else if (isa<MemoryUse>(MA)) {
     MemorySSAWalker *MSSAWalker = MemSSA.getWalker();
     assert(MSSAWalker != nullptr && "Null MemorySSAWalker.");
+    ++NumMemSSAWalks;
     findMemSSAError(I, MSSAWalker->getClobberingMemoryAccess(MA));
   }
   else if (isa<MemoryDef>(MA))
@@ -75,6 +94,179 @@ findMemSSAError(Instruction *I, MemoryAccess *MA) {
   }
 }
 
+const MemSSAClobberCache::Clobbers &
+MemSSAClobberCache::getClobbers(MemoryAccess *MA) {
+  assert(MemSSA != nullptr && MA != nullptr);
+  auto Idx = ResultIdx.find(MA);
+  if (Idx != ResultIdx.end())
+    return Results[Idx->second];
+
+  visit(MA);
+  DFSNum.clear();
+  assert(Stack.empty() && Frames.empty());
+
+  return Results[ResultIdx.lookup(MA)];
+}
+
+void MemSSAClobberCache::visit(MemoryAccess *Root) {
+  pushFrame(Root);
+  while (!Frames.empty()) {
+    Frame &Top = Frames.back();
+    if (Top.Next < Top.Succs.size()) {
+      MemoryAccess *S = Top.Succs[Top.Next++];
+      if (ResultIdx.count(S))
+	continue;
+
+      auto SNum = DFSNum.find(S);
+      if (SNum != DFSNum.end())
+	// S is still on the stack, so it belongs to the current SCC.
+	Top.Low = std::min(Top.Low, SNum->second);
+      else
+	pushFrame(S);
+      continue;
+    }
+
+    MemoryAccess *MA = Top.MA;
+    unsigned Low = Top.Low;
+    Frames.pop_back();
+    if (!Frames.empty())
+      Frames.back().Low = std::min(Frames.back().Low, Low);
+    if (Low == DFSNum.lookup(MA))
+      collapseSCC(MA);
+  }
+}
+
+void MemSSAClobberCache::pushFrame(MemoryAccess *MA) {
+  unsigned Num = NextDFSNum++;
+  DFSNum[MA] = Num;
+  Stack.push_back(MA);
+
+  Frame F;
+  F.MA = MA;
+  getSuccessors(MA, F.Succs);
+  F.Next = 0U;
+  F.Low = Num;
+  Frames.push_back(std::move(F));
+}
+
+void MemSSAClobberCache::collapseSCC(MemoryAccess *Root) {
+  SmallVector<MemoryAccess *, 4U> Members;
+  MemoryAccess *MA;
+  do {
+    MA = Stack.pop_back_val();
+    Members.push_back(MA);
+  } while (MA != Root);
+
+  Clobbers C;
+  SmallVector<MemoryAccess *, 4U> Succs;
+  for (MemoryAccess *M : Members) {
+    addLocalClobbers(M, C);
+
+    // Successors outside this SCC have already been resolved.
+    Succs.clear();
+    getSuccessors(M, Succs);
+    for (MemoryAccess *S : Succs) {
+      auto SIdx = ResultIdx.find(S);
+      if (SIdx == ResultIdx.end())
+	continue;
+      const Clobbers &SC = Results[SIdx->second];
+      C.Defs.insert(SC.Defs.begin(), SC.Defs.end());
+      C.NeedsLOE |= SC.NeedsLOE;
+    }
+  }
+
+  unsigned Idx = Results.size();
+  Results.push_back(std::move(C));
+  for (MemoryAccess *M : Members)
+    ResultIdx[M] = Idx;
+}
+
+void MemSSAClobberCache::getSuccessors(MemoryAccess *MA,
+				       SmallVectorImpl<MemoryAccess *> &Succs) {
+  if (isa<MemoryUse>(MA)) {
+    MemorySSAWalker *MSSAWalker = MemSSA->getWalker();
+    assert(MSSAWalker != nullptr && "Null MemorySSAWalker.");
+    ++NumMemSSAWalks;
+    Succs.push_back(MSSAWalker->getClobberingMemoryAccess(MA));
+  }
+  else if (MemoryPhi *MPhi = dyn_cast<MemoryPhi>(MA)) {
+    for (Use &MU : MPhi->incoming_values())
+      Succs.push_back(cast<MemoryAccess>(&MU));
+  }
+}
+
+void MemSSAClobberCache::addLocalClobbers(MemoryAccess *MA, Clobbers &C) {
+  if (MemSSA->isLiveOnEntryDef(MA)) {
+    C.NeedsLOE = true;
+  }
+  else if (MemoryDef *MD = dyn_cast<MemoryDef>(MA)) {
+    Instruction *MI = MD->getMemoryInst();
+    if (isa<CallInst>(MI) || isa<InvokeInst>(MI))
+      // The computed error should have been attached to the actual parameter.
+      C.NeedsLOE = true;
+    else
+      C.Defs.insert(MI);
+  }
+}
+
+Value *OriginPointerIndex::getOriginPointer(Value *Pointer) {
+  assert(Pointer != nullptr);
+  if (!Built)
+    build();
+
+  return lookup(Pointer);
+}
+
+void OriginPointerIndex::build() {
+  assert(MemSSA != nullptr && F != nullptr);
+  Built = true;
+
+  // Operands and clobbering stores dominate their users,
+  // so they have already been indexed when they are needed.
+  ReversePostOrderTraversal<Function *> RPOT(F);
+  for (BasicBlock *BB : RPOT)
+    for (Instruction &I : *BB)
+      if (I.getType()->isPointerTy())
+	Origins[&I] = computeOrigin(&I);
+}
+
+Value *OriginPointerIndex::lookup(Value *Pointer) {
+  auto Origin = Origins.find(Pointer);
+  if (Origin != Origins.end())
+    return Origin->second;
+
+  // Unreachable code, or values not indexed by build().
+  // Unreachable code may contain cycles, which are broken by the placeholder.
+  Origins[Pointer] = nullptr;
+  Value *Res = computeOrigin(Pointer);
+  Origins[Pointer] = Res;
+  return Res;
+}
+
+Value *OriginPointerIndex::computeOrigin(Value *Pointer) {
+  if (isa<Argument>(Pointer) || isa<AllocaInst>(Pointer)) {
+    return Pointer;
+  }
+  else if (GetElementPtrInst *GEPI = dyn_cast<GetElementPtrInst>(Pointer)) {
+    return lookup(GEPI->getPointerOperand());
+  }
+  else if (BitCastInst *BCI = dyn_cast<BitCastInst>(Pointer)) {
+    return lookup(BCI->getOperand(0U));
+  }
+  else if (LoadInst *LI = dyn_cast<LoadInst>(Pointer)) {
+    MemorySSAWalker *MSSAWalker = MemSSA->getWalker();
+    assert(MSSAWalker != nullptr && "Null MemorySSAWalker.");
+    ++NumMemSSAWalks;
+    if (MemoryDef *MD = dyn_cast<MemoryDef>(MSSAWalker->getClobberingMemoryAccess(LI))) {
+      if (!MemSSA->isLiveOnEntryDef(MD))
+	if (StoreInst *SI = dyn_cast<StoreInst>(MD->getMemoryInst()))
+	  return lookup(SI->getValueOperand());
+    }
+    return lookup(LI->getPointerOperand());
+  }
+  return nullptr;
+}
+
 Value *MemSSAUtils::getOriginPointer(MemorySSA &MemSSA, Value *Pointer) {
   assert(Pointer != nullptr);
 
@@ -90,6 +282,7 @@ Value *MemSSAUtils::getOriginPointer(MemorySSA &MemSSA, Value *Pointer) {
   else if (LoadInst *LI = dyn_cast<LoadInst>(Pointer)) {
     MemorySSAWalker *MSSAWalker = MemSSA.getWalker();
     assert(MSSAWalker != nullptr && "Null MemorySSAWalker.");
+    ++NumMemSSAWalks;
     if (MemoryDef *MD = dyn_cast<MemoryDef>(MSSAWalker->getClobberingMemoryAccess(LI))) {
       if (MemSSA.isLiveOnEntryDef(MD)) {
 	return getOriginPointer(MemSSA, LI->getPointerOperand());
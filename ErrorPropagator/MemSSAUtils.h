@@ -17,19 +17,118 @@
 
 #include "RangeErrorMap.h"
 #include "llvm/Analysis/MemorySSA.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/SetVector.h"
 #include "llvm/ADT/SmallSet.h"
 #include "llvm/ADT/SmallVector.h"
+#include <vector>
 
 namespace ErrorProp {
 
 #define DEFAULT_RE_COUNT 2U
 
+/// Caches the resolution of MemorySSA accesses
+/// to the instructions that define the accessed memory,
+/// so that loads sharing the same clobbers do not walk MemorySSA again.
+/// Results are computed bottom-up, one strongly connected component
+/// of MemoryPhis at a time.
+/// It must be cleared whenever MemorySSA is recomputed.
+class MemSSAClobberCache {
+public:
+  struct Clobbers {
+    /// Instructions whose errors are those of the accessed memory.
+    llvm::SmallSetVector<llvm::Instruction *, DEFAULT_RE_COUNT> Defs;
+    /// True if the error must be looked up in the accessed pointer,
+    /// because memory is defined outside the function or by a call.
+    bool NeedsLOE = false;
+  };
+
+  explicit MemSSAClobberCache(llvm::MemorySSA *MemSSA = nullptr)
+    : MemSSA(MemSSA) {}
+
+  /// Get the clobbers of MA.
+  const Clobbers &getClobbers(llvm::MemoryAccess *MA);
+
+  /// Drop all cached results and start using MemSSA.
+  void reset(llvm::MemorySSA *MemSSA) {
+    this->MemSSA = MemSSA;
+    Results.clear();
+    ResultIdx.clear();
+  }
+
+private:
+  llvm::MemorySSA *MemSSA;
+  std::vector<Clobbers> Results;
+  /// Index of the result of each access in Results.
+  llvm::DenseMap<llvm::MemoryAccess *, unsigned> ResultIdx;
+
+  // State of Tarjan's SCC algorithm, which is run iteratively.
+  struct Frame {
+    llvm::MemoryAccess *MA;
+    llvm::SmallVector<llvm::MemoryAccess *, 4U> Succs;
+    unsigned Next;
+    unsigned Low;
+  };
+  llvm::DenseMap<llvm::MemoryAccess *, unsigned> DFSNum;
+  llvm::SmallVector<llvm::MemoryAccess *, 8U> Stack;
+  llvm::SmallVector<Frame, 8U> Frames;
+  unsigned NextDFSNum = 0U;
+
+  void visit(llvm::MemoryAccess *Root);
+  void pushFrame(llvm::MemoryAccess *MA);
+  void collapseSCC(llvm::MemoryAccess *Root);
+  void getSuccessors(llvm::MemoryAccess *MA,
+		     llvm::SmallVectorImpl<llvm::MemoryAccess *> &Succs);
+  void addLocalClobbers(llvm::MemoryAccess *MA, Clobbers &C);
+};
+
+/// Maps pointers to the Argument or AllocaInst they originate from,
+/// following GEPs, bitcasts, and loads of pointers through MemorySSA.
+/// The index is built for the whole function with a single pass in
+/// reverse post-order on the first query, then each query is a lookup.
+/// Origins only depend on the IR of the function, so the index is kept
+/// when MemorySSA is recomputed for it, and must be reset only if
+/// the function is modified.
+class OriginPointerIndex {
+public:
+  OriginPointerIndex(llvm::MemorySSA *MemSSA = nullptr, llvm::Function *F = nullptr)
+    : MemSSA(MemSSA), F(F), Built(false) {}
+
+  /// Get the origin of Pointer, or nullptr if it is unknown.
+  llvm::Value *getOriginPointer(llvm::Value *Pointer);
+
+  /// Use MemSSA, recomputed for the same function, for later queries.
+  void setMemorySSA(llvm::MemorySSA *MemSSA) {
+    this->MemSSA = MemSSA;
+  }
+
+  /// Drop the index and start using MemSSA for function F.
+  void reset(llvm::MemorySSA *MemSSA, llvm::Function *F) {
+    this->MemSSA = MemSSA;
+    this->F = F;
+    Origins.clear();
+    Built = false;
+  }
+
+private:
+  llvm::MemorySSA *MemSSA;
+  llvm::Function *F;
+  llvm::DenseMap<llvm::Value *, llvm::Value *> Origins;
+  bool Built;
+
+  void build();
+  llvm::Value *lookup(llvm::Value *Pointer);
+  llvm::Value *computeOrigin(llvm::Value *Pointer);
+};
+
 class MemSSAUtils {
 public:
   typedef llvm::SmallVector<const RangeErrorMap::RangeError *, DEFAULT_RE_COUNT> REVector;
 
-  MemSSAUtils(RangeErrorMap &RMap, llvm::MemorySSA &MemSSA)
-    : RMap(RMap), MemSSA(MemSSA) {}
+  /// If Cache is not null, it is used to resolve MemorySSA accesses.
+  MemSSAUtils(RangeErrorMap &RMap, llvm::MemorySSA &MemSSA,
+	      MemSSAClobberCache *Cache = nullptr)
+    : RMap(RMap), MemSSA(MemSSA), Cache(Cache) {}
 
   void findMemSSAError(llvm::Instruction *I, llvm::MemoryAccess *MA);
   void findLOEError(llvm::Instruction *I);
@@ -41,6 +140,7 @@ public:
 private:
   RangeErrorMap &RMap;
   llvm::MemorySSA &MemSSA;
+  MemSSAClobberCache *Cache;
   llvm::SmallSet<llvm::MemoryAccess *, DEFAULT_RE_COUNT> Visited;
   REVector Res;
 
@@ -0,0 +1,86 @@
+//===-- ObjectErrorMap.cpp - Errors of Abstract Memory Objects --*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// A class that keeps track of the ranges and errors stored into
+/// the abstract objects of the points-to analysis.
+///
+//===----------------------------------------------------------------------===//
+
+#include "ObjectErrorMap.h"
+
+#include <algorithm>
+
+namespace ErrorProp {
+
+using namespace llvm;
+
+void ObjectErrorMap::storeRangeError(ObjectId Obj, const RangeError &RE,
+				     const BasicBlock *BB, bool Single) {
+  mergeObjectError(Obj, RE);
+
+  // The store overwrites a single object, at least until the end of BB.
+  if (Single) {
+    LastStore &LS = LastStores[Obj];
+    LS.BB = BB;
+    LS.RE = RE;
+  }
+  else
+    LastStores.erase(Obj);
+}
+
+const ObjectErrorMap::RangeError *
+ObjectErrorMap::getRangeError(ObjectId Obj, const BasicBlock *BB) const {
+  auto LS = LastStores.find(Obj);
+  if (LS != LastStores.end() && LS->second.BB == BB)
+    return &LS->second.RE;
+
+  auto RE = ObjErrors.find(Obj);
+  return (RE != ObjErrors.end()) ? &RE->second : nullptr;
+}
+
+void ObjectErrorMap::update(const ObjectErrorMap &O) {
+  for (const auto &ORE : O.ObjErrors)
+    mergeObjectError(ORE.first, ORE.second);
+
+  // The stores of the other analysis may have overwritten any object.
+  LastStores.clear();
+}
+
+void ObjectErrorMap::mergeObjectError(ObjectId Obj, const RangeError &RE) {
+  auto Old = ObjErrors.find(Obj);
+  if (Old == ObjErrors.end()) {
+    ObjErrors.insert(std::make_pair(Obj, RE));
+    return;
+  }
+
+  // The object may hold any of the stored values:
+  // take the union of their ranges,
+  RangeError &ORE = Old->second;
+  if (ORE.first.isUninitialized())
+    ORE.first = RE.first;
+  else if (!RE.first.isUninitialized()) {
+    ORE.first.Min = std::min(ORE.first.Min, RE.first.Min);
+    ORE.first.Max = std::max(ORE.first.Max, RE.first.Max);
+  }
+
+  // and an error bounding all of them, with a new noise term,
+  // since it is not correlated with any of them in particular.
+  if (!RE.second.hasValue())
+    return;
+  if (!ORE.second.hasValue()) {
+    ORE.second = RE.second;
+    return;
+  }
+  inter_t OldErr = ORE.second->noiseTermsAbsSum();
+  inter_t NewErr = RE.second->noiseTermsAbsSum();
+  ORE.second = AffineForm<inter_t>(0, std::max(OldErr, NewErr));
+}
+
+} // end namespace ErrorProp
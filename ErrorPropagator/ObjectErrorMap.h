@@ -0,0 +1,71 @@
+//===-- ObjectErrorMap.h - Errors of Abstract Memory Objects ----*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// A class that keeps track of the ranges and errors stored into
+/// the abstract objects of the points-to analysis.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef ERRORPROPAGATOR_OBJECTERRORMAP_H
+#define ERRORPROPAGATOR_OBJECTERRORMAP_H
+
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/Optional.h"
+#include "llvm/IR/BasicBlock.h"
+#include "AffineForms.h"
+#include "FixedPoint.h"
+
+namespace ErrorProp {
+
+/// Maps abstract objects to the ranges and errors stored into them.
+/// It is part of the error map of each analysis, so the stores seen by
+/// an analysis only affect the callers it returns to.
+class ObjectErrorMap {
+public:
+  typedef std::pair<FPInterval, llvm::Optional<AffineForm<inter_t> > > RangeError;
+  /// Representative node of the object in the points-to graph.
+  typedef unsigned ObjectId;
+
+  /// Record range and error RE stored into Obj by an instruction in BB.
+  /// If Obj is a single object, later loads in BB read RE only.
+  void storeRangeError(ObjectId Obj, const RangeError &RE,
+		       const llvm::BasicBlock *BB, bool Single);
+
+  /// Get the range and error of Obj read by a load in BB,
+  /// or nullptr if nothing has been stored into it.
+  const RangeError *getRangeError(ObjectId Obj, const llvm::BasicBlock *BB) const;
+
+  /// Forget which stores overwrote single objects,
+  /// e.g. after a call that may store into them.
+  void clearLastStores() { LastStores.clear(); }
+
+  /// Add the errors stored into objects by another analysis,
+  /// e.g. of a function called by this one.
+  void update(const ObjectErrorMap &O);
+
+  std::size_t size() const { return ObjErrors.size(); }
+
+protected:
+  struct LastStore {
+    const llvm::BasicBlock *BB;
+    RangeError RE;
+  };
+
+  /// Bound on the ranges and errors of all stores into each object.
+  llvm::DenseMap<ObjectId, RangeError> ObjErrors;
+  /// Last store into each single object, valid in its basic block only.
+  llvm::DenseMap<ObjectId, LastStore> LastStores;
+
+  void mergeObjectError(ObjectId Obj, const RangeError &RE);
+};
+
+} // end namespace ErrorProp
+
+#endif
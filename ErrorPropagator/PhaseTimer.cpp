@@ -0,0 +1,76 @@
+//===-- PhaseTimer.cpp - Timers for the Phases of the Analysis --*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// Timers for the phases of error propagation, enabled by -time-passes.
+///
+//===----------------------------------------------------------------------===//
+
+#include "PhaseTimer.h"
+
+#include <memory>
+#include "llvm/ADT/Statistic.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/ADT/Twine.h"
+#include "llvm/Pass.h"
+#include "llvm/Support/ManagedStatic.h"
+#include "llvm/Support/raw_ostream.h"
+
+namespace ErrorProp {
+
+using namespace llvm;
+
+namespace {
+
+struct PhaseTimers {
+  TimerGroup Group{"errorprop", "Error Propagation"};
+  // Destroyed before Group.
+  StringMap<std::unique_ptr<Timer>> Timers;
+};
+
+ManagedStatic<PhaseTimers> Timers;
+
+} // end of anonymous namespace
+
+PhaseTimer::PhaseTimer(StringRef Name, StringRef Description) : T(nullptr) {
+  if (TimePassesIsEnabled)
+    start(Name, Description);
+}
+
+PhaseTimer::PhaseTimer(const Instruction &I) : T(nullptr) {
+  if (!TimePassesIsEnabled)
+    return;
+
+  StringRef Opcode = I.getOpcodeName();
+  start((Twine("propagate-") + Opcode).str(),
+	(Twine("Propagation: ") + Opcode).str());
+}
+
+void PhaseTimer::start(StringRef Name, StringRef Description) {
+  std::unique_ptr<Timer> &PT = Timers->Timers[Name];
+  if (PT == nullptr)
+    PT.reset(new Timer(Name, Description, Timers->Group));
+  if (PT->isRunning())
+    return;
+
+  T = PT.get();
+  T->startTimer();
+}
+
+void PhaseTimer::printAll() {
+  if (!TimePassesIsEnabled || !Timers.isConstructed())
+    return;
+
+  Timers->Group.print(*CreateInfoOutputFile());
+  // Otherwise they are printed again when destroyed.
+  for (auto &PT : Timers->Timers)
+    PT.second->clear();
+}
+
+} // end of namespace ErrorProp
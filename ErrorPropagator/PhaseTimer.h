@@ -0,0 +1,55 @@
+//===-- PhaseTimer.h - Timers for the Phases of the Analysis ----*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// Timers for the phases of error propagation, enabled by -time-passes.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef ERRORPROPAGATOR_PHASE_TIMER_H
+#define ERRORPROPAGATOR_PHASE_TIMER_H
+
+#include "llvm/ADT/StringRef.h"
+#include "llvm/IR/Instruction.h"
+#include "llvm/Support/Timer.h"
+
+namespace ErrorProp {
+
+/// Times a phase of the analysis while in scope, if -time-passes is given.
+/// All timers belong to the "errorprop" timer group.
+/// Nested regions of the same phase (e.g. in recursive calls) are timed once,
+/// by the outermost one.
+class PhaseTimer {
+public:
+  PhaseTimer(llvm::StringRef Name, llvm::StringRef Description);
+
+  /// Time the propagation of errors for the opcode of I.
+  explicit PhaseTimer(const llvm::Instruction &I);
+
+  PhaseTimer(const PhaseTimer &) = delete;
+  PhaseTimer &operator=(const PhaseTimer &) = delete;
+
+  ~PhaseTimer() {
+    if (T != nullptr)
+      T->stopTimer();
+  }
+
+  /// Print the timers that have been started to the -info-output-file,
+  /// and reset them.
+  static void printAll();
+
+private:
+  llvm::Timer *T;
+
+  void start(llvm::StringRef Name, llvm::StringRef Description);
+};
+
+} // end of namespace ErrorProp
+
+#endif // ERRORPROPAGATOR_PHASE_TIMER_H
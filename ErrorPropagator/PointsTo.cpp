@@ -0,0 +1,353 @@
+//===-- PointsTo.cpp - Field-sensitive points-to analysis -------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// A flow-insensitive, field-sensitive, unification-based (Steensgaard)
+/// points-to analysis.
+///
+//===----------------------------------------------------------------------===//
+
+#include "PointsTo.h"
+
+#include <algorithm>
+#include <utility>
+#include "llvm/IR/CallSite.h"
+#include "llvm/IR/Constants.h"
+#include "llvm/IR/GetElementPtrTypeIterator.h"
+#include "llvm/IR/InstIterator.h"
+#include "llvm/IR/Instructions.h"
+#include "llvm/IR/IntrinsicInst.h"
+#include "llvm/IR/Operator.h"
+#include "llvm/IR/PatternMatch.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/Support/Debug.h"
+
+namespace ErrorProp {
+
+using namespace llvm;
+using namespace llvm::PatternMatch;
+
+#define DEBUG_TYPE "errorprop"
+
+const PointsToAnalysis::NodeId PointsToAnalysis::NoNode;
+
+PointsToAnalysis::PointsToAnalysis(Module &M) {
+  for (GlobalVariable &GV : M.globals()) {
+    if (!GV.hasInitializer() || !GV.getInitializer()->getType()->isPointerTy())
+      continue;
+    NodeId Init = getPointsTo(GV.getInitializer());
+    if (Init != NoNode)
+      unify(getPointee(getPointsTo(&GV)), Init);
+  }
+
+  for (Function &F : M)
+    for (Instruction &I : instructions(F))
+      visitInstruction(I);
+
+  LLVM_DEBUG(dbgs() << "[taffo-err] Points-to analysis: " << Nodes.size() << " nodes for "
+	     << PointsTo.size() << " pointers.\n");
+}
+
+PointsToAnalysis::NodeId PointsToAnalysis::getPointsTo(Value *Pointer) {
+  assert(Pointer != nullptr);
+  auto N = PointsTo.find(Pointer);
+  if (N != PointsTo.end())
+    return find(N->second);
+
+  if (isa<ConstantPointerNull>(Pointer) || isa<UndefValue>(Pointer))
+    return NoNode;
+
+  // The placeholder breaks cycles through PHIs.
+  NodeId Res = makeNode();
+  Nodes[Res].Sites = getNumSites(Pointer);
+  PointsTo[Pointer] = Res;
+  NodeId Computed = computePointsTo(Pointer);
+  // Existing nodes stay representatives, since analyses key errors by them.
+  if (Computed != NoNode)
+    Res = unify(Computed, Res);
+
+  return find(Res);
+}
+
+bool PointsToAnalysis::isSingleObject(NodeId N) {
+  if (N == NoNode)
+    return false;
+
+  // A struct field is a single object if the struct is.
+  N = find(N);
+  while (Nodes[N].Owner != NoNode)
+    N = find(Nodes[N].Owner);
+  return Nodes[N].Sites == 1U;
+}
+
+void PointsToAnalysis::addClone(const ValueToValueMapTy &VMap) {
+  for (const auto &VV : VMap) {
+    Value *CV = VV.second;
+    if (CV == nullptr || !(isa<Argument>(CV) || isa<Instruction>(CV))
+	|| !CV->getType()->isPointerTy())
+      continue;
+
+    auto N = PointsTo.find(VV.first);
+    if (N != PointsTo.end()) {
+      NodeId Orig = N->second;
+      PointsTo[CV] = Orig;
+    }
+  }
+}
+
+void PointsToAnalysis::removeClone(Function &Copy) {
+  for (Argument &Arg : Copy.args())
+    PointsTo.erase(&Arg);
+  for (Instruction &I : instructions(Copy))
+    PointsTo.erase(&I);
+}
+
+PointsToAnalysis::NodeId PointsToAnalysis::makeNode() {
+  NodeId N = Nodes.size();
+  Nodes.emplace_back();
+  Nodes.back().Parent = N;
+  Nodes.back().Rank = 0U;
+  Nodes.back().Pointee = NoNode;
+  Nodes.back().Sites = 0U;
+  Nodes.back().Owner = NoNode;
+  Nodes.back().FieldIdx = 0U;
+  return N;
+}
+
+PointsToAnalysis::NodeId PointsToAnalysis::find(NodeId N) {
+  assert(N < Nodes.size());
+  NodeId Root = N;
+  while (Nodes[Root].Parent != Root)
+    Root = Nodes[Root].Parent;
+
+  // Path compression.
+  while (Nodes[N].Parent != Root) {
+    NodeId Next = Nodes[N].Parent;
+    Nodes[N].Parent = Root;
+    N = Next;
+  }
+  return Root;
+}
+
+PointsToAnalysis::NodeId PointsToAnalysis::unify(NodeId A, NodeId B) {
+  SmallVector<std::pair<NodeId, NodeId>, 8U> Worklist;
+  Worklist.push_back(std::make_pair(A, B));
+  while (!Worklist.empty()) {
+    NodeId X = find(Worklist.back().first);
+    NodeId Y = find(Worklist.back().second);
+    Worklist.pop_back();
+    if (X == Y)
+      continue;
+
+    if (Nodes[X].Rank < Nodes[Y].Rank)
+      std::swap(X, Y);
+    else if (Nodes[X].Rank == Nodes[Y].Rank)
+      ++Nodes[X].Rank;
+    Nodes[Y].Parent = X;
+
+    // Objects pointed by unified objects must be unified too,
+    // and so must fields with the same index.
+    if (Nodes[Y].Pointee != NoNode) {
+      if (Nodes[X].Pointee == NoNode)
+	Nodes[X].Pointee = Nodes[Y].Pointee;
+      else
+	Worklist.push_back(std::make_pair(Nodes[X].Pointee, Nodes[Y].Pointee));
+    }
+    for (const auto &YF : Nodes[Y].Fields) {
+      auto XF = Nodes[X].Fields.find(YF.first);
+      if (XF == Nodes[X].Fields.end())
+	Nodes[X].Fields[YF.first] = YF.second;
+      else
+	Worklist.push_back(std::make_pair(XF->second, YF.second));
+    }
+    Nodes[Y].Fields.clear();
+    mergeSites(X, Y);
+  }
+  return find(A);
+}
+
+PointsToAnalysis::NodeId PointsToAnalysis::getPointee(NodeId N) {
+  N = find(N);
+  if (Nodes[N].Pointee == NoNode) {
+    NodeId P = makeNode();
+    Nodes[N].Pointee = P;
+  }
+  return find(Nodes[N].Pointee);
+}
+
+PointsToAnalysis::NodeId PointsToAnalysis::getField(NodeId N, unsigned Field) {
+  N = find(N);
+  auto F = Nodes[N].Fields.find(Field);
+  if (F != Nodes[N].Fields.end())
+    return find(F->second);
+
+  NodeId FN = makeNode();
+  Nodes[N].Fields[Field] = FN;
+  Nodes[FN].Owner = N;
+  Nodes[FN].FieldIdx = Field;
+  return FN;
+}
+
+PointsToAnalysis::NodeId PointsToAnalysis::computePointsTo(Value *Pointer) {
+  if (GEPOperator *GEP = dyn_cast<GEPOperator>(Pointer)) {
+    NodeId N = getPointsTo(GEP->getPointerOperand());
+    if (N == NoNode)
+      return NoNode;
+
+    // Array elements and pointer arithmetic are not distinguished,
+    // so the objects they lead to stand for many objects.
+    for (gep_type_iterator GTI = gep_type_begin(GEP), GTE = gep_type_end(GEP);
+	 GTI != GTE; ++GTI)
+      if (GTI.getStructTypeOrNull() != nullptr) {
+	// Struct indices of vector GEPs are splat vectors.
+	const APInt &Idx = cast<Constant>(GTI.getOperand())->getUniqueInteger();
+	N = getField(N, Idx.getZExtValue());
+      }
+      else if (GTI != gep_type_begin(GEP) || !match(GTI.getOperand(), m_Zero()))
+	setManySites(N);
+    return N;
+  }
+
+  if (Operator *Op = dyn_cast<Operator>(Pointer)) {
+    switch (Op->getOpcode()) {
+      case Instruction::BitCast:
+      case Instruction::AddrSpaceCast:
+	return getPointsTo(Op->getOperand(0U));
+      default:
+	break;
+    }
+  }
+
+  if (LoadInst *LI = dyn_cast<LoadInst>(Pointer)) {
+    NodeId N = getPointsTo(LI->getPointerOperand());
+    return (N != NoNode) ? getPointee(N) : NoNode;
+  }
+
+  if (isa<PHINode>(Pointer) || isa<SelectInst>(Pointer)) {
+    NodeId Res = NoNode;
+    User *U = cast<User>(Pointer);
+    for (Value *In : U->operands()) {
+      if (!In->getType()->isPointerTy())
+	continue;
+      NodeId N = getPointsTo(In);
+      if (N != NoNode)
+	Res = (Res == NoNode) ? N : unify(Res, N);
+    }
+    return Res;
+  }
+
+  // Allocas, global variables, arguments and unknown call results
+  // are new objects, possibly unified later.
+  return NoNode;
+}
+
+void PointsToAnalysis::visitInstruction(Instruction &I) {
+  if (I.getType()->isPointerTy())
+    getPointsTo(&I);
+
+  if (StoreInst *SI = dyn_cast<StoreInst>(&I)) {
+    Value *Val = SI->getValueOperand();
+    if (!Val->getType()->isPointerTy())
+      return;
+    NodeId V = getPointsTo(Val);
+    NodeId P = getPointsTo(SI->getPointerOperand());
+    if (V != NoNode && P != NoNode)
+      unify(getPointee(P), V);
+    return;
+  }
+
+  if (MemTransferInst *MT = dyn_cast<MemTransferInst>(&I)) {
+    NodeId D = getPointsTo(MT->getRawDest());
+    NodeId S = getPointsTo(MT->getRawSource());
+    if (D != NoNode && S != NoNode)
+      unify(getPointee(D), getPointee(S));
+    return;
+  }
+
+  CallSite CS(&I);
+  if (!CS)
+    return;
+  Function *F = CS.getCalledFunction();
+  if (F == nullptr || F->isDeclaration())
+    return;
+
+  // Bind actual and formal parameters.
+  auto Formal = F->arg_begin();
+  for (auto Actual = CS.arg_begin(), ActualEnd = CS.arg_end();
+       Actual != ActualEnd && Formal != F->arg_end();
+       ++Actual, ++Formal) {
+    if (!Formal->getType()->isPointerTy())
+      continue;
+    NodeId A = getPointsTo(*Actual);
+    if (A != NoNode)
+      unify(A, getPointsTo(&*Formal));
+  }
+
+  // Bind the returned value.
+  if (!I.getType()->isPointerTy())
+    return;
+  for (BasicBlock &BB : *F)
+    if (ReturnInst *RI = dyn_cast<ReturnInst>(BB.getTerminator()))
+      if (Value *RV = RI->getReturnValue()) {
+	NodeId R = getPointsTo(RV);
+	if (R != NoNode)
+	  unify(getPointsTo(&I), R);
+      }
+}
+
+void PointsToAnalysis::mergeSites(NodeId X, NodeId Y) {
+  Node &NX = Nodes[X];
+  const Node &NY = Nodes[Y];
+  if (NX.Owner != NoNode || NY.Owner != NoNode) {
+    // Struct fields stay single objects only if unified with nodes
+    // that are not objects on their own, or with the same field.
+    if (NX.Owner == NoNode && NX.Sites == 0U) {
+      NX.Owner = NY.Owner;
+      NX.FieldIdx = NY.FieldIdx;
+    }
+    else if (NY.Owner == NoNode && NY.Sites == 0U)
+      return;
+    else if (NX.Owner == NoNode || NY.Owner == NoNode
+	     || NX.FieldIdx != NY.FieldIdx || find(NX.Owner) != find(NY.Owner))
+      setManySites(X);
+    return;
+  }
+
+  NX.Sites = std::min(NX.Sites + NY.Sites, ManySites);
+}
+
+void PointsToAnalysis::setManySites(NodeId N) {
+  N = find(N);
+  Nodes[N].Sites = ManySites;
+  Nodes[N].Owner = NoNode;
+}
+
+unsigned PointsToAnalysis::getNumSites(const Value *Pointer) {
+  // Derived pointers get the sites of the objects they point to.
+  if (isa<GEPOperator>(Pointer) || isa<LoadInst>(Pointer)
+      || isa<PHINode>(Pointer) || isa<SelectInst>(Pointer))
+    return 0U;
+  if (const Operator *Op = dyn_cast<Operator>(Pointer))
+    if (Op->getOpcode() == Instruction::BitCast
+	|| Op->getOpcode() == Instruction::AddrSpaceCast)
+      return 0U;
+
+  // Allocas outside the entry block may be live in several instances.
+  if (const AllocaInst *AI = dyn_cast<AllocaInst>(Pointer))
+    return (!AI->isArrayAllocation()
+	    && AI->getParent() == &AI->getFunction()->getEntryBlock())
+      ? 1U : ManySites;
+  if (isa<GlobalVariable>(Pointer))
+    return 1U;
+
+  // Arguments, call results and the like may point to any object.
+  return ManySites;
+}
+
+} // end of namespace ErrorProp
@@ -0,0 +1,91 @@
+//===-- PointsTo.h - Field-sensitive points-to analysis ---------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// A flow-insensitive, field-sensitive, unification-based (Steensgaard)
+/// points-to analysis, which maps memory accesses to abstract objects.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef ERRORPROPAGATOR_POINTSTO_H
+#define ERRORPROPAGATOR_POINTSTO_H
+
+#include <vector>
+#include "llvm/IR/Module.h"
+#include "llvm/IR/Function.h"
+#include "llvm/IR/Instruction.h"
+#include "llvm/IR/ValueMap.h"
+#include "llvm/Transforms/Utils/ValueMapper.h"
+#include "llvm/ADT/DenseMap.h"
+
+namespace ErrorProp {
+
+/// Points-to analysis over the whole module.
+/// Each abstract object is a node, with one child node for each struct field
+/// accessed through GEPs, and one node for the objects pointed by its content.
+/// Nodes are unified whenever a pointer may point to both of them.
+/// The errors stored into the objects are kept by each analysis
+/// in its ObjectErrorMap.
+class PointsToAnalysis {
+public:
+  typedef unsigned NodeId;
+  static const NodeId NoNode = ~0U;
+
+  /// Compute the points-to graph of all functions in M.
+  PointsToAnalysis(llvm::Module &M);
+
+  /// Get the object pointed by Pointer, or NoNode if it is unknown.
+  NodeId getPointsTo(llvm::Value *Pointer);
+
+  /// True if N stands for a single object at any time,
+  /// so that a store into it overwrites its previous content.
+  bool isSingleObject(NodeId N);
+
+  /// Let the values of Copy point to the same objects
+  /// as the corresponding values of the original function.
+  void addClone(const llvm::ValueToValueMapTy &VMap);
+
+  /// Forget the values of Copy, which is going to be deleted.
+  void removeClone(llvm::Function &Copy);
+
+protected:
+  struct Node {
+    NodeId Parent;
+    unsigned Rank;
+    /// The object pointed by the content of this object.
+    NodeId Pointee;
+    /// Struct fields, by field index.
+    llvm::DenseMap<unsigned, NodeId> Fields;
+    /// Number of allocation sites of the object, up to ManySites.
+    unsigned Sites;
+    /// The object containing this struct field, or NoNode.
+    NodeId Owner;
+    unsigned FieldIdx;
+  };
+  static const unsigned ManySites = 2U;
+
+  std::vector<Node> Nodes;
+  llvm::DenseMap<const llvm::Value *, NodeId> PointsTo;
+
+  NodeId makeNode();
+  NodeId find(NodeId N);
+  NodeId unify(NodeId A, NodeId B);
+  NodeId getPointee(NodeId N);
+  NodeId getField(NodeId N, unsigned Field);
+  void mergeSites(NodeId X, NodeId Y);
+  void setManySites(NodeId N);
+  static unsigned getNumSites(const llvm::Value *Pointer);
+
+  NodeId computePointsTo(llvm::Value *Pointer);
+  void visitInstruction(llvm::Instruction &I);
+};
+
+} // end namespace ErrorProp
+
+#endif
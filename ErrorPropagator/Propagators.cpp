@@ -103,6 +103,9 @@ propagateShr(const AffineForm<inter_t> &E1, const FPInterval &ResR) {
 bool InstructionPropagator::propagateBinaryOp(Instruction &I) {
   BinaryOperator &BI = cast<BinaryOperator>(I);
 
+  if (getNumLanes(BI.getType()) > 0U)
+    return propagateVectorBinaryOp(I);
+
   LLVM_DEBUG(logInstruction(I));
 
   // if (RMap.getRangeError(&I) == nullptr) {
@@ -121,59 +124,69 @@ bool InstructionPropagator::propagateBinaryOp(Instruction &I) {
   }
 
   AffineForm<inter_t> ERes;
-  switch(BI.getOpcode()) {
+  if (!computeBinaryOpError(BI.getOpcode(), *O1, *O2, RMap.getRange(&I), ERes))
+    return false;
+
+  // Add error to RMap.
+  RMap.setError(&BI, ERes);
+
+  LLVM_DEBUG(logErrorln(ERes));
+
+  return true;
+}
+
+bool InstructionPropagator::computeBinaryOpError(unsigned Opcode,
+						 const RangeErrorMap::RangeError &O1,
+						 const RangeErrorMap::RangeError &O2,
+						 const FPInterval *ResR,
+						 AffineForm<inter_t> &ERes) {
+  assert(O1.second.hasValue() && O2.second.hasValue());
+  switch(Opcode) {
     case Instruction::FAdd:
       // Fall-through.
     case Instruction::Add:
-      ERes = propagateAdd(O1->first, *O1->second,
-			  O2->first, *O2->second);
+      ERes = propagateAdd(O1.first, *O1.second,
+			  O2.first, *O2.second);
       break;
     case Instruction::FSub:
       // Fall-through.
     case Instruction::Sub:
-      ERes = propagateSub(O1->first, *O1->second,
-			  O2->first, *O2->second);
+      ERes = propagateSub(O1.first, *O1.second,
+			  O2.first, *O2.second);
       break;
     case Instruction::FMul:
       // Fall-through.
     case Instruction::Mul:
-      ERes = propagateMul(O1->first, *O1->second,
-			  O2->first, *O2->second);
+      ERes = propagateMul(O1.first, *O1.second,
+			  O2.first, *O2.second);
       break;
     case Instruction::FDiv:
-      ERes = propagateDiv(O1->first, *O1->second,
-			  O2->first, *O2->second, false);
+      ERes = propagateDiv(O1.first, *O1.second,
+			  O2.first, *O2.second, false);
       break;
     case Instruction::UDiv:
       // Fall-through.
     case Instruction::SDiv:
-      ERes = propagateDiv(O1->first, *O1->second,
-			  O2->first, *O2->second);
+      ERes = propagateDiv(O1.first, *O1.second,
+			  O2.first, *O2.second);
       break;
     case Instruction::Shl:
-      ERes = propagateShl(*O1->second);
+      ERes = propagateShl(*O1.second);
       break;
     case Instruction::LShr:
       // Fall-through.
     case Instruction::AShr: {
-      const FPInterval *ResR = RMap.getRange(&I);
       if (ResR == nullptr) {
 	LLVM_DEBUG(logInfoln("no data."));
 	return false;
       }
-      ERes = propagateShr(*O1->second, *ResR);
+      ERes = propagateShr(*O1.second, *ResR);
       break;
     }
     default:
       LLVM_DEBUG(logInfoln("not supported.\n"));
       return false;
   }
-
-  // Add error to RMap.
-  RMap.setError(&BI, ERes);
-
-  LLVM_DEBUG(logErrorln(ERes));
-
   return true;
 }
 
@@ -200,6 +213,13 @@ bool InstructionPropagator::propagateStore(Instruction &I) {
 
   // Associate the source error to this store instruction,
   RMap.setRangeError(&SI, *SrcRE);
+  // to the objects pointed by the destination,
+  if (PTA != nullptr) {
+    PointsToAnalysis::NodeId Obj = PTA->getPointsTo(IDest);
+    if (Obj != PointsToAnalysis::NoNode)
+      RMap.storeObjectRangeError(Obj, *SrcRE, SI.getParent(),
+				 PTA->isSingleObject(Obj));
+  }
   // and to the pointer, if greater, and if it is a function Argument.
   updateArgumentRE(IDest, SrcRE);
 
@@ -223,13 +243,26 @@ bool InstructionPropagator::propagateLoad(Instruction &I) {
     return false;
   }
 
-  // Look for range and error in the defining instructions with MemorySSA
-  MemSSAUtils MemUtils(RMap, MemSSA);
-  MemUtils.findMemSSAError(&I, MemSSA.getMemoryAccess(&I));
-
-  // Kludje for when AliasAnalysis fails (i.e. almost always).
-  if (SloppyAA) {
-    MemUtils.findLOEError(&I);
+  MemSSAUtils MemUtils(RMap, MemSSA, ClobberCache);
+  if (PTA != nullptr) {
+    // Points-to data replace MemorySSA, which misses the stores
+    // when AliasAnalysis fails.
+    const RangeErrorMap::RangeError *ObjRE = nullptr;
+    PointsToAnalysis::NodeId Obj = PTA->getPointsTo(LI.getPointerOperand());
+    if (Obj != PointsToAnalysis::NoNode)
+      ObjRE = RMap.getObjectRangeError(Obj, LI.getParent());
+    if (ObjRE != nullptr) {
+      MemUtils.getRangeErrors().push_back(ObjRE);
+      LLVM_DEBUG(logInfo("(points-to) "));
+    }
+    else {
+      // Kludje for when AliasAnalysis fails (i.e. almost always).
+      MemUtils.findLOEError(&I);
+    }
+  }
+  else {
+    // Look for range and error in the defining instructions with MemorySSA
+    MemUtils.findMemSSAError(&I, MemSSA.getMemoryAccess(&I));
   }
 
   MemSSAUtils::REVector &REs = MemUtils.getRangeErrors();
@@ -348,6 +381,9 @@ bool InstructionPropagator::propagateFPToI(Instruction &I) {
     return false;
   }
 
+  if (RMap.hasLaneRangeErrors(I.getOperand(0U)))
+    return lanesPassThrough(I, Range->getRoundingError());
+
   AffineForm<inter_t> NewError = *Error + AffineForm<inter_t>(0.0, Range->getRoundingError());
   RMap.setError(&I, NewError);
 
@@ -358,6 +394,9 @@ bool InstructionPropagator::propagateFPToI(Instruction &I) {
 bool InstructionPropagator::propagateSelect(Instruction &I) {
   SelectInst &SI = cast<SelectInst>(I);
 
+  if (getNumLanes(I.getType()) > 0U)
+    return propagateVectorSelect(I);
+
   LLVM_DEBUG(logInstruction(I));
 
   if (RMap.getRangeError(&I) == nullptr) {
@@ -394,6 +433,9 @@ bool InstructionPropagator::propagateSelect(Instruction &I) {
 bool InstructionPropagator::propagatePhi(Instruction &I) {
   PHINode &PHI = cast<PHINode>(I);
 
+  if (getNumLanes(I.getType()) > 0U)
+    return propagateVectorPhi(I);
+
   LLVM_DEBUG(logInstruction(I));
 
   const FPType *ConstFallbackTy = nullptr;
@@ -533,6 +575,10 @@ bool InstructionPropagator::propagateRet(Instruction &I) {
 bool InstructionPropagator::propagateCall(Instruction &I) {
   LLVM_DEBUG(logInstruction(I));
 
+  // The callee may store into any object.
+  if (I.mayWriteToMemory())
+    RMap.clearLastObjectStores();
+
   Function *F = nullptr;
   if (isa<CallInst>(I)) {
     F = cast<CallInst>(I).getCalledFunction();
@@ -542,6 +588,24 @@ bool InstructionPropagator::propagateCall(Instruction &I) {
     F = cast<InvokeInst>(I).getCalledFunction();
   }
 
+  if (F != nullptr && isVectorReduction(*F)) {
+    return propagateVectorReduction(I, *F);
+  }
+
+  if (F != nullptr && isFixedPointIntrinsic(*F)) {
+    return propagateFixedPointIntrinsic(I, *F);
+  }
+
+  if (F != nullptr && isFMA(*F)) {
+    return propagateFMA(I);
+  }
+
+  if (Summaries != nullptr) {
+    const ErrorSummary *S = Summaries->getSummaryForCall(I, RMap);
+    if (S != nullptr)
+      return propagateSummaryCall(I, *S);
+  }
+
   if (F != nullptr && isSpecialFunction(*F)) {
     return propagateSpecialCall(I, *F);
   }
@@ -564,6 +628,29 @@ bool InstructionPropagator::propagateCall(Instruction &I) {
   return true;
 }
 
+bool InstructionPropagator::propagateSummaryCall(Instruction &I,
+						 const ErrorSummary &S) {
+  LLVM_DEBUG(logInfo("(summary)"));
+
+  // Errors on the arguments are scaled by the sensitivities,
+  // keeping their noise terms.
+  AffineForm<inter_t> Error = (S.Error > 0.0)
+    ? AffineForm<inter_t>(0.0, S.Error) : AffineForm<inter_t>(0.0);
+  for (unsigned Idx = 0U; Idx < S.Sensitivity.size(); ++Idx) {
+    auto *ArgRE = getOperandRangeError(I, Idx);
+    if (ArgRE == nullptr || !ArgRE->second.hasValue())
+      continue;
+
+    Error = Error + ArgRE->second->scalarMultiply(S.Sensitivity[Idx]);
+  }
+
+  RMap.setError(&I, Error);
+
+  LLVM_DEBUG(logErrorln(Error));
+
+  return true;
+}
+
 bool InstructionPropagator::propagateGetElementPtr(Instruction &I) {
   GetElementPtrInst &GEPI = cast<GetElementPtrInst>(I);
 
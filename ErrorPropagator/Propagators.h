@@ -19,13 +19,23 @@
 #include "llvm/IR/Instruction.h"
 #include "llvm/Analysis/MemorySSA.h"
 #include "RangeErrorMap.h"
+#include "MemSSAUtils.h"
+#include "PointsTo.h"
+#include "ErrorSummary.h"
 
 namespace ErrorProp {
 
+struct SpecialFunctionInfo;
+
 class InstructionPropagator {
 public:
-  InstructionPropagator(RangeErrorMap &RMap, llvm::MemorySSA &MemSSA, bool SloppyAA)
-    : RMap(RMap), MemSSA(MemSSA), SloppyAA(SloppyAA) {}
+  InstructionPropagator(RangeErrorMap &RMap, llvm::MemorySSA &MemSSA,
+			PointsToAnalysis *PTA = nullptr,
+			MemSSAClobberCache *ClobberCache = nullptr,
+			OriginPointerIndex *Origins = nullptr,
+			const ErrorSummaryDB *Summaries = nullptr)
+    : RMap(RMap), MemSSA(MemSSA), PTA(PTA),
+      ClobberCache(ClobberCache), Origins(Origins), Summaries(Summaries) {}
 
   /// Propagate errors for a Binary Operator instruction.
   bool propagateBinaryOp(llvm::Instruction &);
@@ -74,8 +84,14 @@ public:
   /// than the one already associated (if any).
   bool propagateRet(llvm::Instruction &I);
 
+  /// True if F is an elementary function in the SpecialFunctionRegistry,
+  /// or a single-argument function with no body.
   static bool isSpecialFunction(llvm::Function &F);
 
+  /// True if F computes a fused multiply-add
+  /// (llvm.fma, llvm.fmuladd, fma, fmaf and fmal).
+  static bool isFMA(llvm::Function &F);
+
   /// Associate the error of the called function to I.
   /// Works woth both CallInst and InvokeInst.
   bool propagateCall(llvm::Instruction &I);
@@ -86,10 +102,33 @@ public:
   bool propagateExtractValue(llvm::Instruction &I);
   bool propagateInsertValue(llvm::Instruction &I);
 
+  /// Associate the error of the extracted lane to I,
+  /// or the largest error among lanes if the index is not constant.
+  bool propagateExtractElement(llvm::Instruction &I);
+
+  /// Associate the errors of the source vector to the lanes of I,
+  /// replacing the error of the inserted lane.
+  bool propagateInsertElement(llvm::Instruction &I);
+
+  /// Associate the errors of the selected source lanes to the lanes of I.
+  bool propagateShuffleVector(llvm::Instruction &I);
+
+  /// True if F is a vector reduction intrinsic (llvm.vector.reduce.*).
+  static bool isVectorReduction(llvm::Function &F);
+
+  /// True if F is a fixed point or saturating arithmetic intrinsic
+  /// (llvm.[su]mul.fix[.sat], llvm.[su]div.fix[.sat], llvm.[su]add.sat, llvm.[su]sub.sat).
+  static bool isFixedPointIntrinsic(llvm::Function &F);
+
 private:
   RangeErrorMap &RMap;
   llvm::MemorySSA &MemSSA;
-  bool SloppyAA;
+  /// Points-to data, available only with sloppy alias analysis.
+  PointsToAnalysis *PTA;
+  MemSSAClobberCache *ClobberCache;
+  OriginPointerIndex *Origins;
+  /// Error summaries of library functions, if any.
+  const ErrorSummaryDB *Summaries;
 
   const RangeErrorMap::RangeError *getConstantFPRangeError(llvm::ConstantFP *VFP);
 
@@ -108,21 +147,58 @@ private:
 		       bool DoublePP = false,
 		       const mdutils::FPType *FallbackTy = nullptr);
 
+  /// Range and error of lane Lane of operand V of I.
+  /// Lanes of constant vectors are handled like scalar constants.
+  const RangeErrorMap::RangeError*
+  getOperandLaneRangeError(llvm::Instruction &I, llvm::Value *V, unsigned Lane,
+			   bool DoublePP = false,
+			   const mdutils::FPType *FallbackTy = nullptr);
+
+  const RangeErrorMap::RangeError*
+  getConstantVectorRangeError(llvm::Instruction &I, llvm::Constant *VC,
+			      bool DoublePP = false,
+			      const mdutils::FPType *FallbackTy = nullptr);
+
   void updateArgumentRE(llvm::Value *Pointer, const RangeErrorMap::RangeError *NewRE);
 
   bool unOpErrorPassThrough(llvm::Instruction &I);
 
-  static bool isSqrt(llvm::Function &F);
-  static bool isLog(llvm::Function &F);
-  static bool isExp(llvm::Function &F);
-  static bool isAcos(llvm::Function &F);
-  static bool isAsin(llvm::Function &F);
-  bool propagateSqrt(llvm::Instruction &I);
-  bool propagateLog(llvm::Instruction &I);
-  bool propagateExp(llvm::Instruction &I);
-  bool propagateAcos(llvm::Instruction &I);
-  bool propagateAsin(llvm::Instruction &I);
+  /// Compute the error of a binary operation with the given operands.
+  /// ResR is the range of the result, needed for right shifts.
+  /// Returns false if the operation is not supported.
+  bool computeBinaryOpError(unsigned Opcode,
+			    const RangeErrorMap::RangeError &O1,
+			    const RangeErrorMap::RangeError &O2,
+			    const FPInterval *ResR,
+			    AffineForm<inter_t> &ERes);
+
+  /// Number of lanes of T if it is a fixed-width vector, 0 otherwise.
+  static unsigned getNumLanes(const llvm::Type *T);
+
+  /// Range and error of a lane with no data.
+  static RangeErrorMap::RangeError getEmptyLane();
+
+  /// Range and error of a lane computed by I with error Err.
+  /// The range of I is used if available, otherwise SrcR (if not null).
+  RangeErrorMap::RangeError makeLane(llvm::Instruction &I,
+				     const AffineForm<inter_t> &Err,
+				     const FPInterval *SrcR = nullptr);
+
+  /// Lane by lane variants of the propagators above.
+  bool propagateVectorBinaryOp(llvm::Instruction &I);
+  bool propagateVectorSelect(llvm::Instruction &I);
+  bool propagateVectorPhi(llvm::Instruction &I);
+  bool lanesPassThrough(llvm::Instruction &I, inter_t RoundingError = 0.0);
+  bool propagateVectorReduction(llvm::Instruction &I, llvm::Function &Called);
+  bool propagateFixedPointIntrinsic(llvm::Instruction &I, llvm::Function &Called);
+  bool setLaneErrors(llvm::Instruction &I,
+		     llvm::ArrayRef<RangeErrorMap::RangeError> Lanes);
+
   bool propagateSpecialCall(llvm::Instruction &I, llvm::Function &Called);
+  bool propagateBinarySpecialCall(llvm::Instruction &I,
+				  const SpecialFunctionInfo &Info);
+  bool propagateFMA(llvm::Instruction &I);
+  bool propagateSummaryCall(llvm::Instruction &I, const ErrorSummary &S);
 
   inter_t computeMinRangeDiff(const FPInterval &R1, const FPInterval &R2);
 
@@ -66,6 +66,30 @@ InstructionPropagator::getConstantRangeError(Instruction &I, ConstantInt *VInt,
   return RMap.getRangeError(VInt);
 }
 
+const RangeErrorMap::RangeError *
+InstructionPropagator::getConstantVectorRangeError(Instruction &I, Constant *VC,
+						   bool DoublePP,
+						   const FPType *FallbackTy) {
+  if (RMap.hasLaneRangeErrors(VC))
+    return RMap.getRangeError(VC);
+
+  // Each lane is interpreted as a scalar constant.
+  unsigned NumLanes = getNumLanes(VC->getType());
+  SmallVector<RangeErrorMap::RangeError, 4U> Lanes;
+  Lanes.reserve(NumLanes);
+  for (unsigned Lane = 0U; Lane < NumLanes; ++Lane) {
+    Constant *Elt = VC->getAggregateElement(Lane);
+    const RangeErrorMap::RangeError *EltRE = nullptr;
+    if (Elt != nullptr && !isa<UndefValue>(Elt))
+      EltRE = getOperandRangeError(I, Elt, DoublePP, FallbackTy);
+
+    Lanes.push_back((EltRE != nullptr) ? *EltRE : getEmptyLane());
+  }
+
+  RMap.setLaneRangeErrors(VC, Lanes);
+  return RMap.getRangeError(VC);
+}
+
 const RangeErrorMap::RangeError*
 InstructionPropagator::getOperandRangeError(Instruction &I, Value *V,
 					    bool DoublePP, const FPType *FallbackTy) {
@@ -80,6 +104,11 @@ InstructionPropagator::getOperandRangeError(Instruction &I, Value *V,
   if (VFP != nullptr)
     return getConstantFPRangeError(VFP);
 
+  // Vector constants are handled lane by lane.
+  if (getNumLanes(V->getType()) > 0U
+      && isa<Constant>(V) && !isa<ConstantExpr>(V))
+    return getConstantVectorRangeError(I, cast<Constant>(V), DoublePP, FallbackTy);
+
   // Otherwise, check if Range and Error have already been computed.
   return RMap.getRangeError(V);
 }
@@ -95,13 +124,27 @@ InstructionPropagator::getOperandRangeError(Instruction &I, unsigned Op,
   return getOperandRangeError(I, V, DoublePP, FallbackTy);
 }
 
+const RangeErrorMap::RangeError*
+InstructionPropagator::getOperandLaneRangeError(Instruction &I, Value *V, unsigned Lane,
+						bool DoublePP,
+						const FPType *FallbackTy) {
+  assert(V != nullptr);
+
+  // Make sure the lanes of constants have been computed.
+  if (isa<Constant>(V) && !isa<ConstantExpr>(V))
+    getOperandRangeError(I, V, DoublePP, FallbackTy);
+
+  return RMap.getLaneRangeError(V, Lane);
+}
+
 void InstructionPropagator::
 updateArgumentRE(Value *Pointer,
 		 const RangeErrorMap::RangeError *NewRE) {
   assert(Pointer != nullptr);
   assert(NewRE != nullptr);
 
-  Pointer = MemSSAUtils::getOriginPointer(MemSSA, Pointer);
+  Pointer = (Origins != nullptr) ? Origins->getOriginPointer(Pointer)
+    : MemSSAUtils::getOriginPointer(MemSSA, Pointer);
   if (Pointer != nullptr) {
     auto *PointerRE = RMap.getRangeError(Pointer);
     if (PointerRE == nullptr || !PointerRE->second.hasValue()
@@ -115,6 +158,10 @@ updateArgumentRE(Value *Pointer,
 bool InstructionPropagator::unOpErrorPassThrough(Instruction &I) {
   // assert(isa<UnaryInstruction>(I) && "Must be Unary.");
 
+  if (getNumLanes(I.getType()) > 0U
+      && RMap.hasLaneRangeErrors(I.getOperand(0U)))
+    return lanesPassThrough(I);
+
   auto *OpRE = getOperandRangeError(I, 0U);
   if (OpRE == nullptr || !OpRE->second.hasValue()) {
     LLVM_DEBUG(logInfoln("no data."));
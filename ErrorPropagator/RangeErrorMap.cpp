@@ -83,6 +83,49 @@ void RangeErrorMap::setRangeError(const Value *I,
   }
 }
 
+const RangeErrorMap::RangeError *
+RangeErrorMap::getLaneRangeError(const Value *V, unsigned Lane) const {
+  auto Lanes = LaneMap.find(V);
+  if (Lanes == LaneMap.end())
+    return getRangeError(V);
+
+  if (Lane >= Lanes->second.size())
+    return nullptr;
+  return &(Lanes->second[Lane]);
+}
+
+void RangeErrorMap::setLaneRangeErrors(const Value *V, ArrayRef<RangeError> Lanes) {
+  LaneMap[V].assign(Lanes.begin(), Lanes.end());
+
+  // Summarize lanes for users of the whole vector.
+  // Lanes with unknown bounds are skipped when joining ranges.
+  inter_t MaxAbsErr = -1.0;
+  inter_t Min = std::numeric_limits<inter_t>::infinity();
+  inter_t Max = -std::numeric_limits<inter_t>::infinity();
+  for (const RangeError &RE : Lanes) {
+    if (!RE.second.hasValue())
+      continue;
+
+    MaxAbsErr = std::max(MaxAbsErr, RE.second->noiseTermsAbsSum());
+    if (RE.first.hasBounds()) {
+      Min = std::min(Min, RE.first.Min);
+      Max = std::max(Max, RE.first.Max);
+    }
+  }
+  if (MaxAbsErr < 0.0)
+    return;
+
+  const FPInterval *Range = getRange(V);
+  if (Range != nullptr && !Range->isUninitialized())
+    setError(V, AffineForm<inter_t>(0.0, MaxAbsErr));
+  else {
+    if (Min > Max)
+      Min = Max = std::numeric_limits<inter_t>::quiet_NaN();
+    setRangeError(V, std::make_pair(FPInterval(Interval<inter_t>(Min, Max)),
+				    AffineForm<inter_t>(0.0, MaxAbsErr)));
+  }
+}
+
 bool RangeErrorMap::retrieveRangeError(Instruction &I) {
   retrieveConstRanges(I);
 
@@ -226,6 +269,23 @@ void RangeErrorMap::updateTargets(const RangeErrorMap &Other) {
   this->TErrs.updateAllTargets(Other.TErrs);
 }
 
+RangeErrorMap::MemoryUsage RangeErrorMap::getMemoryUsage() const {
+  MemoryUsage U;
+  U.Entries = REMap.size();
+  U.AffineBytes = 0U;
+  for (const auto &RE : REMap)
+    if (RE.second.second.hasValue())
+      U.AffineBytes += RE.second.second->getMemoryUsage();
+  for (const auto &Lanes : LaneMap) {
+    U.Entries += Lanes.second.size();
+    for (const RangeError &RE : Lanes.second)
+      if (RE.second.hasValue())
+	U.AffineBytes += RE.second->getMemoryUsage();
+  }
+  U.StructBytes = SEMap.getMemoryUsage();
+  return U;
+}
+
 double RangeErrorMap::computeRelativeError(const RangeError &RE) {
   double divisor = std::max(std::abs(RE.first.Min), std::abs(RE.first.Max));
   if (divisor != 0)
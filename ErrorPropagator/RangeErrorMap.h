@@ -26,6 +26,7 @@
 #include "AffineForms.h"
 #include "FixedPoint.h"
 #include "StructErrorMap.h"
+#include "ObjectErrorMap.h"
 
 namespace ErrorProp {
 
@@ -39,6 +40,10 @@ public:
 
   inter_t getErrorForTarget(llvm::StringRef T) const;
 
+  typedef llvm::DenseMap<llvm::StringRef, inter_t>::const_iterator const_iterator;
+  const_iterator begin() const { return Targets.begin(); }
+  const_iterator end() const { return Targets.end(); }
+
   void printTargetErrors(llvm::raw_ostream &OS) const;
 
 protected:
@@ -50,7 +55,7 @@ public:
   typedef std::pair<FPInterval, llvm::Optional<AffineForm<inter_t> > > RangeError;
 
   RangeErrorMap(mdutils::MetadataManager &MDManager, bool Absolute = true, bool ExactConst = false)
-    : REMap(), MDMgr(&MDManager), SEMap(), TErrs(),
+    : REMap(), LaneMap(), MDMgr(&MDManager), SEMap(), OEMap(), TErrs(),
       OutputAbsolute(Absolute), ExactConst(ExactConst) {}
 
   const FPInterval *getRange(const llvm::Value *) const;
@@ -70,8 +75,24 @@ public:
 
   void erase(const llvm::Value *V) {
     REMap.erase(V);
+    LaneMap.erase(V);
+  }
+
+  /// Get range and error of lane Lane of vector V.
+  /// If no per-lane data has been computed for V,
+  /// the range and error of the whole vector are returned.
+  const RangeError *getLaneRangeError(const llvm::Value *V, unsigned Lane) const;
+
+  /// True if range and error have been computed for each lane of V.
+  bool hasLaneRangeErrors(const llvm::Value *V) const {
+    return LaneMap.count(V) != 0U;
   }
 
+  /// Set range and error of each lane of vector V.
+  /// Lanes with no error are allowed (e.g. undef lanes).
+  /// The largest error among lanes is associated to V as a whole.
+  void setLaneRangeErrors(const llvm::Value *V, llvm::ArrayRef<RangeError> Lanes);
+
   /// Retrieve range for instruction I from metadata.
   /// Return true if initial error metadata was found attached to I.
   bool retrieveRangeError(llvm::Instruction &I);
@@ -101,17 +122,47 @@ public:
     SEMap.updateStructTree(O.SEMap, Pointers);
   }
 
+  /// Range and error of the abstract object Obj, read by a load in BB.
+  const RangeError *getObjectRangeError(ObjectErrorMap::ObjectId Obj,
+					const llvm::BasicBlock *BB) const {
+    return OEMap.getRangeError(Obj, BB);
+  }
+  void storeObjectRangeError(ObjectErrorMap::ObjectId Obj, const RangeError &RE,
+			     const llvm::BasicBlock *BB, bool Single) {
+    OEMap.storeRangeError(Obj, RE, BB, Single);
+  }
+  void clearLastObjectStores() { OEMap.clearLastStores(); }
+  void updateObjectErrors(const RangeErrorMap &O) { OEMap.update(O.OEMap); }
+
   void updateTargets(const RangeErrorMap &Other);
   void printTargetErrors(llvm::raw_ostream &OS) const { TErrs.printTargetErrors(OS); }
+  const TargetErrors &getTargetErrors() const { return TErrs; }
 
   double getOutputError(const llvm::Value *V) const;
   double getOutputError(const RangeError &RE) const;
 
   bool isExactConst() const { return ExactConst; }
+
+  struct MemoryUsage {
+    /// Number of values and vector lanes with range or error.
+    size_t Entries;
+    /// Bytes held by their errors.
+    size_t AffineBytes;
+    /// Bytes held by the errors of struct fields.
+    size_t StructBytes;
+  };
+
+  /// Estimate the memory held by the ranges and errors in this map.
+  MemoryUsage getMemoryUsage() const;
+
 protected:
   std::map<const llvm::Value *, RangeError> REMap;
+  /// Ranges and errors of each lane of vector values.
+  std::map<const llvm::Value *, llvm::SmallVector<RangeError, 4U> > LaneMap;
   mdutils::MetadataManager *MDMgr;
   StructErrorMap SEMap;
+  /// Errors stored into abstract objects, only with points-to data.
+  ObjectErrorMap OEMap;
   TargetErrors TErrs;
   bool OutputAbsolute;
   bool ExactConst;
@@ -1,136 +1,382 @@
 #include "Propagators.h"
 
+#include <algorithm>
+#include <cmath>
+#include "llvm/IR/CallSite.h"
+#include "llvm/IR/Instructions.h"
+#include "llvm/IR/Intrinsics.h"
+#include "llvm/Support/Debug.h"
+#include "SpecialFunctions.h"
+
 namespace ErrorProp {
 
+#define DEBUG_TYPE "errorprop"
+
 using namespace llvm;
 
-bool InstructionPropagator::isSqrt(Function &F) {
-  StringRef FName = F.getName();
-  return FName == "sqrtf"
-    || FName == "sqrt"
-    || FName == "_ZSt4sqrtf"
-    || (FName.find("sqrt") != StringRef::npos
-	&& FName.find("fixp") != StringRef::npos)
-    || FName == "_ZSt4sqrtf_fixp";
+namespace {
+
+const inter_t Pi = 3.14159265358979323846264338327950288L;
+
+/// Return the value with the largest magnitude, ignoring NaNs.
+inter_t getLargest(inter_t A, inter_t B) {
+  if (std::isnan(A) || std::abs(B) > std::abs(A))
+    return B;
+  return A;
 }
 
-bool InstructionPropagator::isLog(Function &F) {
-  StringRef FName = F.getName();
-  return FName == "log"
-    || FName == "logf"
-    || FName == "_ZSt3logf"
-    || (FName.find("log") != StringRef::npos
-	&& FName.find("fixp") != StringRef::npos);
+/// Smallest absolute value in R.
+inter_t minAbs(const Interval<inter_t> &R) {
+  if (R.Min <= 0 && R.Max >= 0)
+    return 0;
+  return std::min(std::abs(R.Min), std::abs(R.Max));
 }
 
-bool InstructionPropagator::isExp(Function &F) {
-  StringRef FName = F.getName();
-  return FName == "expf"
-    || FName == "exp"
-    || FName == "_ZSt3expf"
-    || (FName.find("exp") != StringRef::npos
-	&& FName.find("fixp") != StringRef::npos);
+/// Largest absolute value in R.
+inter_t maxAbs(const Interval<inter_t> &R) {
+  return std::max(std::abs(R.Min), std::abs(R.Max));
 }
 
-bool InstructionPropagator::isAcos(Function &F) {
-  StringRef FName = F.getName();
-  return F.getName() == "acos"
-    || F.getName() == "acosf"
-    || (FName.find("acos") != StringRef::npos
-	&& FName.find("fixp") != StringRef::npos);
+/// Give Bound the sign of the values in R, if they all have the same sign.
+inter_t signOf(const Interval<inter_t> &R, inter_t Bound) {
+  return (R.Max <= 0 && R.Min < 0) ? -Bound : Bound;
 }
 
-bool InstructionPropagator::isAsin(Function &F) {
-  StringRef FName = F.getName();
-  return F.getName() == "asin"
-    || F.getName() == "asinf"
-    || (FName.find("asin") != StringRef::npos
-	&& FName.find("fixp") != StringRef::npos);;
+/// |x| / (x^2 + y^2), for each y, is largest at |x| = |y|
+/// and decreases with |y|.
+inter_t atan2PartialBound(const Interval<inter_t> &RX,
+			  const Interval<inter_t> &RY) {
+  inter_t Y = minAbs(RY);
+  inter_t X = std::max(minAbs(RX), std::min(Y, maxAbs(RX)));
+  if (X == 0 && Y == 0)
+    return std::numeric_limits<inter_t>::infinity();
+  return X / (X*X + Y*Y);
 }
 
-bool InstructionPropagator::isSpecialFunction(Function &F) {
-  return F.arg_size() == 1U
-    && (F.empty() || !F.hasName()
-	|| isSqrt(F) || isLog(F) || isExp(F) || isAcos(F) || isAsin(F));
+/// |x| / hypot(x, y) increases with |x| and decreases with |y|.
+inter_t hypotPartialBound(const Interval<inter_t> &RX,
+			  const Interval<inter_t> &RY) {
+  inter_t H = std::hypot(maxAbs(RX), minAbs(RY));
+  return (H > 0) ? maxAbs(RX) / H : 1;
 }
 
-bool InstructionPropagator::propagateSqrt(Instruction &I) {
-  LLVM_DEBUG(dbgs() << "(special: sqrt) ");
-  auto *OpRE = getOperandRangeError(I, 0U);
-  if (OpRE == nullptr || !OpRE->second.hasValue()) {
-    LLVM_DEBUG(dbgs() << "no data.\n");
-    return false;
+/// Bound of |x^y ln x| for x in [L, U], on one side of 1, and a fixed y:
+/// it is largest at x = e^(-1/y) if it is in range, otherwise it is monotone.
+inter_t powPartialYSideBound(inter_t L, inter_t U, inter_t Y) {
+  if (Y != 0) {
+    inter_t XPeak = std::exp(-1 / Y);
+    if (L <= XPeak && XPeak <= U)
+      return 1 / (std::exp(static_cast<inter_t>(1)) * std::abs(Y));
   }
+  auto G = [Y](inter_t X) {
+    if (X == 0)
+      return (Y > 0) ? static_cast<inter_t>(0) : std::numeric_limits<inter_t>::infinity();
+    return std::abs(std::pow(X, Y) * std::log(X));
+  };
+  return std::max(G(L), G(U));
+}
 
-  const FPInterval *IRange = RMap.getRange(&I);
-  AffineForm<inter_t> NewErr =
-    LinearErrorApproximationDecr([](inter_t x){ return static_cast<inter_t>(0.5) / std::sqrt(x); },
-				 OpRE->first, OpRE->second.getValue())
-    + ((IRange) ? AffineForm<inter_t>(0.0, IRange->getRoundingError()) :
-    AffineForm<inter_t>(0.0, OpRE->first.getRoundingError()));
+/// Bound of |x^y ln x| for x in RX, which must be non-negative.
+/// x^y decreases with y below 1 and increases above 1.
+inter_t powPartialYBound(const Interval<inter_t> &RX,
+			 const Interval<inter_t> &RY) {
+  const inter_t One = 1;
+  inter_t Res = 0;
+  if (RX.Min < One)
+    Res = powPartialYSideBound(RX.Min, std::min(RX.Max, One), RY.Min);
+  if (RX.Max > One)
+    Res = std::max(Res, powPartialYSideBound(std::max(RX.Min, One), RX.Max, RY.Max));
+  return Res;
+}
 
-  RMap.setError(&I, NewErr);
+/// Bound of |y x^(y-1)|: x^(y-1) is monotone in each argument,
+/// so it is largest at one of the corners.
+inter_t powPartialXBound(const Interval<inter_t> &RX,
+			 const Interval<inter_t> &RY) {
+  inter_t MaxY = maxAbs(RY);
+  if (MaxY == 0)
+    return 0;
+  inter_t MaxPow = std::max(std::max(std::pow(RX.Min, RY.Min - 1),
+				     std::pow(RX.Min, RY.Max - 1)),
+			    std::max(std::pow(RX.Max, RY.Min - 1),
+				     std::pow(RX.Max, RY.Max - 1)));
+  return MaxY * MaxPow;
+}
 
-  LLVM_DEBUG(dbgs() << static_cast<double>(NewErr.noiseTermsAbsSum()) << ".\n");
-  return true;
+/// Multiply the error of an argument by the derivative D.
+/// Exact arguments do not contribute any error, even if D is infinite.
+AffineForm<inter_t> scaleError(const AffineForm<inter_t> &Err, inter_t D) {
+  if (Err.noiseTermsAbsSum() == 0)
+    return AffineForm<inter_t>(0.0);
+  if (std::isinf(D))
+    return AffineForm<inter_t>(0.0, std::numeric_limits<inter_t>::infinity());
+  return Err.scalarMultiply(D);
 }
 
-bool InstructionPropagator::propagateLog(Instruction &I) {
-  LLVM_DEBUG(dbgs() << "(special: log) ");
-  auto *OpRE = getOperandRangeError(I, 0U);
-  if (OpRE == nullptr || !OpRE->second.hasValue()) {
-    LLVM_DEBUG(dbgs() << "no data.\n");
-    return false;
+/// Strip the decorations that do not change the computed function.
+StringRef getBaseName(StringRef Name) {
+  // Fixed point versions, e.g. sqrtf_fixp or _ZSt4sqrtf_fixp.1.
+  size_t FixpPos = Name.find("_fixp");
+  if (FixpPos != StringRef::npos)
+    Name = Name.take_front(FixpPos);
+
+  // LLVM intrinsics, e.g. llvm.sqrt.f64.
+  Name.consume_front("llvm.");
+
+  // Mangled names of free functions, e.g. _ZSt4sqrtf or _Z4sqrtd.
+  if (Name.consume_front("_ZSt") || Name.consume_front("_Z")) {
+    unsigned Len;
+    if (Name.consumeInteger(10, Len) || Len > Name.size())
+      return StringRef();
+    Name = Name.take_front(Len);
   }
 
-  const FPInterval *IRange = RMap.getRange(&I);
-  AffineForm<inter_t> NewErr =
-    LinearErrorApproximationDecr([](inter_t x){ return static_cast<inter_t>(1) / x; },
-				 OpRE->first, OpRE->second.getValue())
-    + ((IRange) ? AffineForm<inter_t>(0.0, IRange->getRoundingError()) :
-    AffineForm<inter_t>(0.0, OpRE->first.getRoundingError()));
+  // Type suffixes of intrinsics and suffixes of cloned functions.
+  return Name.take_until([](char C) { return C == '.'; });
+}
 
-  RMap.setError(&I, NewErr);
+} // end of anonymous namespace
 
-  LLVM_DEBUG(dbgs() << static_cast<double>(NewErr.noiseTermsAbsSum()) << ".\n");
-  return true;
+SpecialFunctionInfo
+SpecialFunctionInfo::unary(StringRef Name, UnaryDerivative Der,
+			   DerivativeShape Shape) {
+  SpecialFunctionInfo Info;
+  Info.Name = Name.str();
+  Info.NumArgs = 1U;
+  Info.Der = std::move(Der);
+  Info.Shape = Shape;
+  return Info;
 }
 
-bool InstructionPropagator::propagateExp(Instruction &I) {
-  LLVM_DEBUG(dbgs() << "(special: exp) ");
-  auto *OpRE = getOperandRangeError(I, 0U);
-  if (OpRE == nullptr || !OpRE->second.hasValue()) {
-    LLVM_DEBUG(dbgs() << "no data.\n");
-    return false;
+SpecialFunctionInfo
+SpecialFunctionInfo::peaked(StringRef Name, UnaryDerivative Der,
+			    inter_t Peak, inter_t Period) {
+  SpecialFunctionInfo Info = unary(Name, std::move(Der), DerivativeShape::Peaked);
+  Info.Peak = Peak;
+  Info.Period = Period;
+  return Info;
+}
+
+SpecialFunctionInfo
+SpecialFunctionInfo::binary(StringRef Name, BinaryDerivativeBounds DerBounds) {
+  SpecialFunctionInfo Info;
+  Info.Name = Name.str();
+  Info.NumArgs = 2U;
+  Info.DerBounds = std::move(DerBounds);
+  return Info;
+}
+
+Interval<inter_t>
+SpecialFunctionInfo::clampToDomain(const Interval<inter_t> &R) const {
+  return Interval<inter_t>(std::max(DomainMin, R.Min),
+			   std::min(DomainMax, R.Max));
+}
+
+inter_t SpecialFunctionInfo::getWorstDerivative(const Interval<inter_t> &R) const {
+  assert(NumArgs == 1U && Der);
+  inter_t Min = std::min(R.Min, R.Max);
+  inter_t Max = std::max(R.Min, R.Max);
+  switch (Shape) {
+    case DerivativeShape::Decreasing:
+      return Der(Min);
+    case DerivativeShape::Increasing:
+      return Der(Max);
+    case DerivativeShape::Peaked: {
+      // First peak not below Min.
+      inter_t X = Peak;
+      if (Period > 0.0)
+	X += std::ceil((Min - Peak) / Period) * Period;
+      if (Min <= X && X <= Max)
+	return (PeakIsPole) ? std::numeric_limits<inter_t>::infinity() : Der(X);
+      LLVM_FALLTHROUGH;
+    }
+    case DerivativeShape::Endpoints:
+      return getLargest(Der(Min), Der(Max));
   }
+  llvm_unreachable("Unknown derivative shape.");
+}
 
-  const FPInterval *IRange = RMap.getRange(&I);
-  AffineForm<inter_t> NewErr =
-    LinearErrorApproximationIncr([](inter_t x){ return std::exp(x); },
-				 OpRE->first, OpRE->second.getValue())
-    + ((IRange) ? AffineForm<inter_t>(0.0, IRange->getRoundingError()) :
-    AffineForm<inter_t>(0.0, OpRE->first.getRoundingError()));
+void SpecialFunctionInfo::getWorstDerivatives(const Interval<inter_t> &RX,
+					      const Interval<inter_t> &RY,
+					      inter_t &DX, inter_t &DY) const {
+  assert(NumArgs == 2U && DerBounds);
+  if (std::isnan(RX.Min) || std::isnan(RY.Min)) {
+    DX = DY = std::numeric_limits<inter_t>::quiet_NaN();
+    return;
+  }
+  DerBounds(RX, RY, DX, DY);
+}
 
-  RMap.setError(&I, NewErr);
+SpecialFunctionRegistry::SpecialFunctionRegistry() {
+  typedef DerivativeShape DS;
+  typedef SpecialFunctionInfo SFI;
 
-  LLVM_DEBUG(dbgs() << static_cast<double>(NewErr.noiseTermsAbsSum()) << ".\n");
+  registerFunction(SFI::unary("sqrt", [](inter_t x) { return static_cast<inter_t>(0.5) / std::sqrt(x); },
+			      DS::Decreasing));
+  registerFunction(SFI::peaked("cbrt", [](inter_t x) { return static_cast<inter_t>(1) / (3 * std::cbrt(x * x)); },
+			       0.0));
+  registerFunction(SFI::unary("log", [](inter_t x) { return static_cast<inter_t>(1) / x; },
+			      DS::Decreasing));
+  registerFunction(SFI::unary("log2", [](inter_t x) { return static_cast<inter_t>(1) / (x * std::log(static_cast<inter_t>(2))); },
+			      DS::Decreasing));
+  registerFunction(SFI::unary("log10", [](inter_t x) { return static_cast<inter_t>(1) / (x * std::log(static_cast<inter_t>(10))); },
+			      DS::Decreasing));
+  registerFunction(SFI::unary("log1p", [](inter_t x) { return static_cast<inter_t>(1) / (1 + x); },
+			      DS::Decreasing));
+  registerFunction(SFI::unary("exp", [](inter_t x) { return std::exp(x); },
+			      DS::Increasing));
+  registerFunction(SFI::unary("exp2", [](inter_t x) { return std::log(static_cast<inter_t>(2)) * std::exp2(x); },
+			      DS::Increasing));
+  registerFunction(SFI::unary("expm1", [](inter_t x) { return std::exp(x); },
+			      DS::Increasing));
+  registerFunction(SFI::peaked("sin", [](inter_t x) { return std::cos(x); },
+			       0.0, Pi));
+  registerFunction(SFI::peaked("cos", [](inter_t x) { return -std::sin(x); },
+			       Pi / 2, Pi));
+  registerFunction(SFI::peaked("tan", [](inter_t x) { return static_cast<inter_t>(1) / (std::cos(x) * std::cos(x)); },
+			       Pi / 2, Pi).setPoles());
+  registerFunction(SFI::unary("asin", [](inter_t x) { return static_cast<inter_t>(1) / std::sqrt(1 - x*x); },
+			      DS::Endpoints).setDomain(-0.99, 0.99));
+  registerFunction(SFI::unary("acos", [](inter_t x) { return static_cast<inter_t>(-1) / std::sqrt(1 - x*x); },
+			      DS::Endpoints).setDomain(-0.99, 0.99));
+  registerFunction(SFI::peaked("atan", [](inter_t x) { return static_cast<inter_t>(1) / (1 + x*x); },
+			       0.0));
+  registerFunction(SFI::unary("sinh", [](inter_t x) { return std::cosh(x); },
+			      DS::Endpoints));
+  registerFunction(SFI::unary("cosh", [](inter_t x) { return std::sinh(x); },
+			      DS::Endpoints));
+  registerFunction(SFI::peaked("tanh", [](inter_t x) { return 1 - std::tanh(x) * std::tanh(x); },
+			       0.0));
+
+  // Binary derivatives are not maximized at the corners of the ranges,
+  // so they are bounded analytically over the whole box.
+  registerFunction(SFI::binary("pow",
+			       [](const Interval<inter_t> &RX, const Interval<inter_t> &RY,
+				  inter_t &DX, inter_t &DY) {
+				 DX = signOf(RY, powPartialXBound(RX, RY));
+				 // ln x < 0 below 1.
+				 DY = (RX.Max <= 1) ? -powPartialYBound(RX, RY)
+				   : powPartialYBound(RX, RY);
+			       })
+		   .setDomain(0.0, std::numeric_limits<inter_t>::infinity()));
+  // atan2(y, x): d/dy = x / (x^2 + y^2), d/dx = -y / (x^2 + y^2).
+  registerFunction(SFI::binary("atan2",
+			       [](const Interval<inter_t> &RY, const Interval<inter_t> &RX,
+				  inter_t &DY, inter_t &DX) {
+				 DY = signOf(RX, atan2PartialBound(RX, RY));
+				 DX = -signOf(RY, atan2PartialBound(RY, RX));
+			       }));
+  registerFunction(SFI::binary("hypot",
+			       [](const Interval<inter_t> &RX, const Interval<inter_t> &RY,
+				  inter_t &DX, inter_t &DY) {
+				 DX = signOf(RX, hypotPartialBound(RX, RY));
+				 DY = signOf(RY, hypotPartialBound(RY, RX));
+			       }));
+}
+
+SpecialFunctionRegistry &SpecialFunctionRegistry::get() {
+  static SpecialFunctionRegistry Registry;
+  return Registry;
+}
+
+void SpecialFunctionRegistry::registerFunction(const SpecialFunctionInfo &Info) {
+  assert((Info.NumArgs == 1U && Info.Der)
+	 || (Info.NumArgs == 2U && Info.DerBounds));
+  // Existing entries are overwritten in place, so cached pointers stay valid.
+  Entries[Info.Name] = Info;
+  Resolved.clear();
+}
+
+bool SpecialFunctionRegistry::registerAlias(StringRef Alias, StringRef Name) {
+  if (lookupCanonical(Name) == nullptr)
+    return false;
+
+  Aliases[Alias] = Name.str();
+  Resolved.clear();
   return true;
 }
 
-bool InstructionPropagator::propagateAcos(Instruction &I) {
-  LLVM_DEBUG(dbgs() << "(special: acos) ");
+const SpecialFunctionInfo *SpecialFunctionRegistry::lookup(const Function &F) {
+  auto It = Resolved.find(&F);
+  if (It != Resolved.end())
+    return It->second;
+
+  const SpecialFunctionInfo *Info = (F.hasName()) ? resolve(F.getName()) : nullptr;
+  Resolved.insert(std::make_pair(&F, Info));
+  return Info;
+}
+
+const SpecialFunctionInfo *
+SpecialFunctionRegistry::resolve(StringRef FName) const {
+  auto Alias = Aliases.find(FName);
+  if (Alias != Aliases.end())
+    return lookupCanonical(Alias->second);
+
+  StringRef Base = getBaseName(FName);
+  if (Base.empty())
+    return nullptr;
+
+  Alias = Aliases.find(Base);
+  if (Alias != Aliases.end())
+    return lookupCanonical(Alias->second);
+
+  return lookupCanonical(Base);
+}
+
+const SpecialFunctionInfo *
+SpecialFunctionRegistry::lookupCanonical(StringRef Name) const {
+  auto It = Entries.find(Name);
+  if (It != Entries.end())
+    return &It->second;
+
+  // Float and long double variants, e.g. sqrtf and sqrtl.
+  if (Name.endswith("f") || Name.endswith("l")) {
+    It = Entries.find(Name.drop_back());
+    if (It != Entries.end())
+      return &It->second;
+  }
+  return nullptr;
+}
+
+bool InstructionPropagator::isSpecialFunction(Function &F) {
+  const SpecialFunctionInfo *Info = SpecialFunctionRegistry::get().lookup(F);
+  if (Info != nullptr)
+    return F.arg_size() == Info->NumArgs;
+
+  // Other single-argument functions with no body pass errors through.
+  return F.arg_size() == 1U && (F.empty() || !F.hasName());
+}
+
+bool InstructionPropagator::propagateSpecialCall(Instruction &I, Function &Called) {
+  assert(InstructionPropagator::isSpecialFunction(Called));
+  const SpecialFunctionInfo *Info = SpecialFunctionRegistry::get().lookup(Called);
+  if (Info == nullptr) {
+    LLVM_DEBUG(dbgs() << "(special pass-through) ");
+    return unOpErrorPassThrough(I);
+  }
+
+  LLVM_DEBUG(dbgs() << "(special: " << Info->Name << ") ");
+  if (Info->NumArgs == 2U)
+    return propagateBinarySpecialCall(I, *Info);
+
   auto *OpRE = getOperandRangeError(I, 0U);
   if (OpRE == nullptr || !OpRE->second.hasValue()) {
     LLVM_DEBUG(dbgs() << "no data.\n");
     return false;
   }
-  Interval<inter_t> R(std::max(static_cast<inter_t>(-0.99), OpRE->first.Min),
-		      std::min(static_cast<inter_t>(0.99),  OpRE->first.Max));
+
+  Interval<inter_t> R = Info->clampToDomain(OpRE->first);
+  inter_t DFx = Info->getWorstDerivative(R);
+  LLVM_DEBUG(dbgs() << "(R = [" << static_cast<double>(R.Min)
+	     << ", " << static_cast<double>(R.Max)
+	     << "], dFx = " << static_cast<double>(DFx) << ") ");
+  if (std::isnan(DFx)) {
+    LLVM_DEBUG(dbgs() << "no data.\n");
+    return false;
+  }
 
   const FPInterval *IRange = RMap.getRange(&I);
-  AffineForm<inter_t> NewErr =
-    LinearErrorApproximationIncr([](inter_t x){ return static_cast<inter_t>(-1) / std::sqrt(1 - x*x); },
-				 R, OpRE->second.getValue())
+  AffineForm<inter_t> NewErr = scaleError(*OpRE->second, DFx)
     + ((IRange) ? AffineForm<inter_t>(0.0, IRange->getRoundingError()) :
     AffineForm<inter_t>(0.0, OpRE->first.getRoundingError()));
 
@@ -140,22 +386,31 @@ bool InstructionPropagator::propagateAcos(Instruction &I) {
   return true;
 }
 
-bool InstructionPropagator::propagateAsin(Instruction &I) {
-  LLVM_DEBUG(dbgs() << "(special: asin) ");
-  auto *OpRE = getOperandRangeError(I, 0U);
-  if (OpRE == nullptr || !OpRE->second.hasValue()) {
+bool InstructionPropagator::propagateBinarySpecialCall(Instruction &I,
+						       const SpecialFunctionInfo &Info) {
+  auto *XRE = getOperandRangeError(I, 0U);
+  auto *YRE = getOperandRangeError(I, 1U);
+  if (XRE == nullptr || !XRE->second.hasValue()
+      || YRE == nullptr || !YRE->second.hasValue()) {
+    LLVM_DEBUG(dbgs() << "no data.\n");
+    return false;
+  }
+
+  inter_t DFx, DFy;
+  Info.getWorstDerivatives(Info.clampToDomain(XRE->first), YRE->first, DFx, DFy);
+  LLVM_DEBUG(dbgs() << "(dFx = " << static_cast<double>(DFx)
+	     << ", dFy = " << static_cast<double>(DFy) << ") ");
+  if (std::isnan(DFx) || std::isnan(DFy)) {
     LLVM_DEBUG(dbgs() << "no data.\n");
     return false;
   }
-  Interval<inter_t> R(std::max(static_cast<inter_t>(-0.99), OpRE->first.Min),
-		      std::min(static_cast<inter_t>(0.99),  OpRE->first.Max));
 
+  // Errors on both arguments are combined keeping their correlation.
   const FPInterval *IRange = RMap.getRange(&I);
-  AffineForm<inter_t> NewErr =
-    LinearErrorApproximationIncr([](inter_t x){ return static_cast<inter_t>(1) / std::sqrt(1 - x*x); },
-				 R, OpRE->second.getValue())
+  AffineForm<inter_t> NewErr = scaleError(*XRE->second, DFx)
+    + scaleError(*YRE->second, DFy)
     + ((IRange) ? AffineForm<inter_t>(0.0, IRange->getRoundingError()) :
-    AffineForm<inter_t>(0.0, OpRE->first.getRoundingError()));
+    AffineForm<inter_t>(0.0, XRE->first.getRoundingError()));
 
   RMap.setError(&I, NewErr);
 
@@ -163,27 +418,76 @@ bool InstructionPropagator::propagateAsin(Instruction &I) {
   return true;
 }
 
-bool InstructionPropagator::propagateSpecialCall(Instruction &I, Function &Called) {
-  assert(InstructionPropagator::isSpecialFunction(Called));
-  if (isSqrt(Called)) {
-    return propagateSqrt(I);
-  }
-  else if (isLog(Called)) {
-    return propagateLog(I);
-  }
-  else if (isExp(Called)) {
-    return propagateExp(I);
+bool InstructionPropagator::isFMA(Function &F) {
+  switch (F.getIntrinsicID()) {
+    case Intrinsic::fma:
+      // Fall-through.
+    case Intrinsic::fmuladd:
+      return true;
+    case Intrinsic::not_intrinsic: {
+      StringRef FName = F.getName();
+      return F.arg_size() == 3U
+	&& (FName == "fma" || FName == "fmaf" || FName == "fmal");
+    }
+    default:
+      return false;
   }
-  else if (isAcos(Called)) {
-    return propagateAcos(I);
-  }
-  else if (isAsin(Called)) {
-    return propagateAsin(I);
-  }
-  else {
-    LLVM_DEBUG(dbgs() << "(special pass-through) ");
-    return unOpErrorPassThrough(I);
+}
+
+bool InstructionPropagator::propagateFMA(Instruction &I) {
+  LLVM_DEBUG(dbgs() << "(special: fma) ");
+  CallSite CS(&I);
+  Function *Called = CS.getCalledFunction();
+  assert(Called != nullptr);
+
+  // The product and the addend of fma are summed before rounding,
+  // so the only rounding error is the one of the result.
+  // llvm.fmuladd may be computed as a product followed by an addition,
+  // so the product may be rounded as well.
+  const FPInterval *IRange = RMap.getRange(&I);
+  inter_t RoundingError = (IRange) ? IRange->getRoundingError() : 0.0;
+  if (Called->getIntrinsicID() == Intrinsic::fmuladd)
+    RoundingError *= 2;
+
+  unsigned NumLanes = getNumLanes(I.getType());
+  SmallVector<RangeErrorMap::RangeError, 4U> Lanes;
+  Lanes.reserve(NumLanes);
+  for (unsigned Lane = 0U; Lane < std::max(NumLanes, 1U); ++Lane) {
+    const RangeErrorMap::RangeError *Ops[3U];
+    bool HasData = true;
+    for (unsigned Op = 0U; Op < 3U; ++Op) {
+      Ops[Op] = (NumLanes > 0U)
+	? getOperandLaneRangeError(I, CS.getArgument(Op), Lane)
+	: getOperandRangeError(I, CS.getArgument(Op));
+      HasData &= Ops[Op] != nullptr && Ops[Op]->second.hasValue();
+    }
+    if (!HasData) {
+      if (NumLanes == 0U) {
+	LLVM_DEBUG(dbgs() << "no data.\n");
+	return false;
+      }
+      Lanes.push_back(getEmptyLane());
+      continue;
+    }
+
+    // Noise terms shared by the product and the addend are kept together.
+    AffineForm<inter_t> NewErr;
+    if (!computeBinaryOpError(Instruction::FMul, *Ops[0U], *Ops[1U], nullptr, NewErr))
+      return false;
+    NewErr = NewErr + *Ops[2U]->second;
+    if (RoundingError > 0.0)
+      NewErr = NewErr + AffineForm<inter_t>(0.0, RoundingError);
+
+    if (NumLanes == 0U) {
+      RMap.setError(&I, NewErr);
+
+      LLVM_DEBUG(dbgs() << static_cast<double>(NewErr.noiseTermsAbsSum()) << ".\n");
+      return true;
+    }
+    Lanes.push_back(makeLane(I, NewErr));
   }
+
+  return setLaneErrors(I, Lanes);
 }
 
 } // end of namespace ErrorProp
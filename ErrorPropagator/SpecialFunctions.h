@@ -0,0 +1,149 @@
+//===-- SpecialFunctions.h - Elementary Function Registry -------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// Registry of the elementary functions whose error is propagated
+/// through their derivatives.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef ERRORPROPAGATOR_SPECIAL_FUNCTIONS_H
+#define ERRORPROPAGATOR_SPECIAL_FUNCTIONS_H
+
+#include <functional>
+#include <limits>
+#include <string>
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/IR/Function.h"
+
+#include "AffineForms.h"
+#include "FixedPoint.h"
+
+namespace ErrorProp {
+
+/// Where the absolute value of the derivative of a function
+/// reaches its maximum on an interval.
+enum class DerivativeShape {
+  /// |f'| is largest at the lower bound.
+  Decreasing,
+  /// |f'| is largest at the upper bound.
+  Increasing,
+  /// |f'| is largest at one of the bounds.
+  Endpoints,
+  /// |f'| is largest at Peak + k * Period, if any is in range,
+  /// otherwise at one of the bounds.
+  Peaked
+};
+
+struct SpecialFunctionInfo {
+  typedef std::function<inter_t(inter_t)> UnaryDerivative;
+  /// Sets DX and DY to values whose magnitude bounds the partial derivatives
+  /// over the whole RX x RY box, with their sign if it is constant there.
+  typedef std::function<void(const Interval<inter_t> &RX,
+			     const Interval<inter_t> &RY,
+			     inter_t &DX, inter_t &DY)> BinaryDerivativeBounds;
+
+  /// Canonical name, e.g. "sqrt".
+  std::string Name;
+  unsigned NumArgs = 1U;
+
+  /// Derivative of unary functions.
+  UnaryDerivative Der;
+  DerivativeShape Shape = DerivativeShape::Endpoints;
+  inter_t Peak = 0.0;
+  /// Distance between peaks of |f'|, 0 if there is only one.
+  inter_t Period = 0.0;
+  /// True if f' diverges at the peaks, e.g. at the poles of tan.
+  bool PeakIsPole = false;
+
+  /// Bounds of the partial derivatives of binary functions.
+  BinaryDerivativeBounds DerBounds;
+
+  /// The range of the first argument is clamped to these bounds.
+  inter_t DomainMin = -std::numeric_limits<inter_t>::infinity();
+  inter_t DomainMax = std::numeric_limits<inter_t>::infinity();
+
+  static SpecialFunctionInfo unary(llvm::StringRef Name, UnaryDerivative Der,
+				   DerivativeShape Shape);
+  static SpecialFunctionInfo peaked(llvm::StringRef Name, UnaryDerivative Der,
+				    inter_t Peak, inter_t Period = 0.0);
+  static SpecialFunctionInfo binary(llvm::StringRef Name,
+				    BinaryDerivativeBounds DerBounds);
+
+  SpecialFunctionInfo &setDomain(inter_t Min, inter_t Max) {
+    DomainMin = Min;
+    DomainMax = Max;
+    return *this;
+  }
+
+  SpecialFunctionInfo &setPoles() {
+    PeakIsPole = true;
+    return *this;
+  }
+
+  /// Clamp R to the domain of the first argument.
+  Interval<inter_t> clampToDomain(const Interval<inter_t> &R) const;
+
+  /// Value of f' where |f'| is largest in R,
+  /// infinity if R contains a pole, NaN if f' is undefined there.
+  inter_t getWorstDerivative(const Interval<inter_t> &R) const;
+
+  /// Bounds of the partial derivatives over RX x RY,
+  /// infinity if they are unbounded, NaN if they are undefined.
+  void getWorstDerivatives(const Interval<inter_t> &RX,
+			   const Interval<inter_t> &RY,
+			   inter_t &DX, inter_t &DY) const;
+};
+
+/// Maps the names of elementary functions to their SpecialFunctionInfo.
+/// Mangled names (_ZSt4sqrtf), float and long double variants (sqrtf, sqrtl),
+/// LLVM intrinsics (llvm.sqrt.f64) and fixed point versions (sqrtf_fixp)
+/// are resolved to the canonical entry.
+class SpecialFunctionRegistry {
+public:
+  static SpecialFunctionRegistry &get();
+
+  /// Add or replace the entry for Info.Name.
+  void registerFunction(const SpecialFunctionInfo &Info);
+
+  /// Make Alias resolve to the entry for Name.
+  /// Returns false if Name is not registered.
+  bool registerAlias(llvm::StringRef Alias, llvm::StringRef Name);
+
+  /// Lookup the entry for a function name, or nullptr if none.
+  const SpecialFunctionInfo *lookup(llvm::StringRef FName) const {
+    return resolve(FName);
+  }
+  /// Lookup the entry for F, caching the result.
+  const SpecialFunctionInfo *lookup(const llvm::Function &F);
+
+  /// Forget the cached entries of functions, which may be deleted
+  /// (e.g. before the analysis of another module).
+  void clearCache() { Resolved.clear(); }
+
+private:
+  /// Entries by canonical name.
+  llvm::StringMap<SpecialFunctionInfo> Entries;
+  /// Canonical names of user-defined aliases.
+  llvm::StringMap<std::string> Aliases;
+  /// Cached resolution of each function seen so far.
+  /// Functions that are not elementary functions map to nullptr.
+  llvm::DenseMap<const llvm::Function *, const SpecialFunctionInfo *> Resolved;
+
+  SpecialFunctionRegistry();
+
+  const SpecialFunctionInfo *resolve(llvm::StringRef FName) const;
+  const SpecialFunctionInfo *lookupCanonical(llvm::StringRef Name) const;
+};
+
+} // end of namespace ErrorProp
+
+#endif // ERRORPROPAGATOR_SPECIAL_FUNCTIONS_H
@@ -14,7 +14,8 @@
 
 #include "StructErrorMap.h"
 
-#include <memory>
+#include <algorithm>
+#include "llvm/IR/Constants.h"
 #include "llvm/IR/Instructions.h"
 #include "llvm/IR/GlobalVariable.h"
 #include "llvm/Support/Debug.h"
@@ -27,59 +28,95 @@ using namespace mdutils;
 
 #define DEBUG_TYPE "errorprop"
 
-StructNode::StructNode(const StructInfo *SI, StructType *ST, StructTree *Parent)
-  : StructTree(STK_Node, Parent), Fields(), SType(ST) {
-  assert(ST != nullptr);
-  Fields.resize(ST->getNumElements());
+namespace {
 
-  LLVM_DEBUG(dbgs() << "{ ");
-  for (std::size_t Idx = 0; Idx < SI->size(); ++Idx) {
-    const MDInfo *FieldMDI = SI->getField(Idx);
-    if (FieldMDI == nullptr) {
-      LLVM_DEBUG(dbgs() << "null ,");
-      continue;
-    }
-
-    if (const StructInfo *FieldSI = dyn_cast<StructInfo>(FieldMDI)) {
-      Fields[Idx].reset(new StructNode(FieldSI,
-				       getElementStructType(ST->getElementType(Idx)),
-				       this));
-    }
-    else if (const InputInfo *FieldII = dyn_cast<InputInfo>(FieldMDI)) {
-      Fields[Idx].reset(new StructError(FieldII, this));
+/// Strip pointer and array types from T, until a struct is found.
+/// An index is consumed from Indices for each array level.
+/// Returns false if T is not a struct or there are not enough indices.
+bool stripToStruct(Type *&T, ArrayRef<unsigned> Indices, unsigned &Pos) {
+  while (true) {
+    if (PointerType *PT = dyn_cast<PointerType>(T)) {
+      T = PT->getElementType();
     }
-    else {
-      llvm_unreachable("Unhandled MDInfo kind.");
+    else if (SequentialType *STy = dyn_cast<SequentialType>(T)) {
+      // Elements of an array are not distinguished.
+      T = STy->getElementType();
+      if (Pos >= Indices.size())
+	return false;
+      ++Pos;
     }
-    LLVM_DEBUG(dbgs() << ", ");
+    else
+      return isa<StructType>(T);
   }
-  LLVM_DEBUG(dbgs() << "}");
 }
 
-StructNode::StructNode(const StructNode &SN)
-  : StructTree(SN), Fields(), SType(SN.SType) {
-  this->Fields.reserve(SN.Fields.size());
-  for (const std::unique_ptr<StructTree> &STPtr : SN.Fields) {
-    std::unique_ptr<StructTree> New;
-    if (STPtr != nullptr)
-      New.reset(STPtr->clone());
-    this->Fields.push_back(std::move(New));
+} // end of anonymous namespace
+
+const StructFieldLayout *StructLayoutCache::getLayout(StructType *ST) {
+  assert(ST != nullptr);
+  auto L = Layouts.find(ST);
+  if (L != Layouts.end())
+    return L->second;
+
+  InProgress.insert(ST);
+
+  unsigned NumFields = ST->getNumElements();
+  StructFieldLayout *NewL = Arena.Allocate<StructFieldLayout>();
+  NewL->Type = ST;
+  NewL->NumFields = NumFields;
+  NewL->IsSummary = false;
+  NewL->Offsets = Arena.Allocate<unsigned>(NumFields);
+  NewL->Nested = Arena.Allocate<const StructFieldLayout *>(NumFields);
+
+  unsigned NumSlots = 0U;
+  for (unsigned Idx = 0U; Idx < NumFields; ++Idx) {
+    NewL->Offsets[Idx] = NumSlots;
+    StructType *FieldST = getElementStructType(ST->getElementType(Idx));
+    if (FieldST == nullptr) {
+      NewL->Nested[Idx] = nullptr;
+      ++NumSlots;
+      continue;
+    }
+
+    // Back edges of recursive types get the summary of the type.
+    NewL->Nested[Idx] = InProgress.count(FieldST)
+      ? getSummaryLayout(FieldST) : getLayout(FieldST);
+    NumSlots += NewL->Nested[Idx]->NumSlots;
   }
+  NewL->NumSlots = NumSlots;
+
+  InProgress.erase(ST);
+  Layouts[ST] = NewL;
+  return NewL;
 }
 
-StructNode &StructNode::operator=(const StructNode &O) {
-  this->SType = O.SType;
-  this->Fields.clear();
-  this->Fields.reserve(O.Fields.size());
-  for (const std::unique_ptr<StructTree> &STPtr : O.Fields) {
-    std::unique_ptr<StructTree> New(STPtr->clone());
-    this->Fields.push_back(std::move(New));
+const StructFieldLayout *StructLayoutCache::getSummaryLayout(StructType *ST) {
+  assert(ST != nullptr);
+  auto L = Summaries.find(ST);
+  if (L != Summaries.end())
+    return L->second;
+
+  unsigned NumFields = ST->getNumElements();
+  StructFieldLayout *NewL = Arena.Allocate<StructFieldLayout>();
+  NewL->Type = ST;
+  NewL->NumFields = NumFields;
+  NewL->NumSlots = NumFields;
+  NewL->IsSummary = true;
+  NewL->Offsets = Arena.Allocate<unsigned>(NumFields);
+  NewL->Nested = Arena.Allocate<const StructFieldLayout *>(NumFields);
+
+  // Each field has a single slot, and pointers to ST lead back to the summary.
+  for (unsigned Idx = 0U; Idx < NumFields; ++Idx) {
+    NewL->Offsets[Idx] = Idx;
+    NewL->Nested[Idx] = (getElementStructType(ST->getElementType(Idx)) == ST)
+      ? NewL : nullptr;
   }
 
-  return *this;
+  Summaries[ST] = NewL;
+  return NewL;
 }
 
-StructType *StructNode::getElementStructType(Type *T) {
+StructType *StructLayoutCache::getElementStructType(Type *T) {
   while (!T->isStructTy()) {
     if (PointerType *PT = dyn_cast<PointerType>(T))
       T = PT->getElementType();
@@ -91,164 +128,15 @@ StructType *StructNode::getElementStructType(Type *T) {
   return cast<StructType>(T);
 }
 
-StructError::StructError(const InputInfo *II, StructTree *Parent)
-  : StructTree(STK_Error, Parent), Error() {
-  FPInterval FPI(II);
-
-  LLVM_DEBUG(dbgs() << "{Range: [" << static_cast<double>(FPI.Min) << ", "
-	<< static_cast<double>(FPI.Max) << "], Error: ");
-
-  if (FPI.hasInitialError()) {
-    AffineForm<inter_t> Err(0.0, FPI.getInitialError());
-    Error = std::make_pair(FPI, Err);
-
-    LLVM_DEBUG(dbgs() << FPI.getInitialError() << "} ");
-  }
-  else {
-    Error = std::make_pair(FPI, NoneType());
-
-    LLVM_DEBUG(dbgs() << "none}");
-  }
-}
-
-Value *StructTreeWalker::retrieveRootPointer(Value *P) {
-  IndexStack.clear();
-  return navigatePointerTreeToRoot(P);
-}
-
-StructError *StructTreeWalker::getOrCreateFieldNode(StructTree *Root) {
-  return navigateStructTree(Root, true);
-}
-
-StructError *StructTreeWalker::getFieldNode(StructTree *Root) {
-  return navigateStructTree(Root, false);
-}
-
-StructTree *StructTreeWalker::makeRoot(Value *P) {
-  StructType *ST = cast<StructType>(cast<PointerType>(P->getType())->getElementType());
-  return new StructNode(ST);
-}
-
-Value *StructTreeWalker::navigatePointerTreeToRoot(Value *P) {
-  assert(P != nullptr);
-  if (GetElementPtrInst *GEPI = dyn_cast<GetElementPtrInst>(P)) {
-    auto IdxIt = GEPI->idx_begin();
-    ++IdxIt;
-    for (; IdxIt != GEPI->idx_end(); ++IdxIt)
-      IndexStack.push_back(parseIndex(*IdxIt));
-
-    return navigatePointerTreeToRoot(GEPI->getPointerOperand());
-  }
-  else if (ConstantExpr *CE = dyn_cast<ConstantExpr>(P)) {
-    if (CE->isGEPWithNoNotionalOverIndexing()) {
-      auto OpIt = CE->op_begin();
-
-      // Get the Pointer Operand.
-      assert(OpIt != CE->op_end());
-      Value *PointerOp = *OpIt;
-      assert(PointerOp->getType()->isPointerTy());
-      ++OpIt;
-
-      // Discard first index.
-      assert(OpIt != CE->op_end());
-      ++OpIt;
-
-      // Push other indices.
-      for (; OpIt != CE->op_end(); ++OpIt)
-	IndexStack.push_back(parseIndex(*OpIt));
-
-      return navigatePointerTreeToRoot(PointerOp);
-    }
-    else
-      return nullptr;
-  }
-  else if (LoadInst *LI = dyn_cast<LoadInst>(P)) {
-    return navigatePointerTreeToRoot(LI->getPointerOperand());
-  }
-  else if (Argument *A = dyn_cast<Argument>(P)) {
-    auto AArg = ArgBindings.find(A);
-    if (AArg != ArgBindings.end() && AArg->second != nullptr)
-      return navigatePointerTreeToRoot(AArg->second);
-    else
-      return (isa<StructType>(cast<PointerType>(A->getType())->getElementType())) ? P : nullptr;
-  }
-  else if (AllocaInst *AI = dyn_cast<AllocaInst>(P)) {
-    return (isa<StructType>(AI->getAllocatedType())) ? P : nullptr;
-  }
-  else if (GlobalVariable *GV = dyn_cast<GlobalVariable>(P)) {
-    return (GV->getValueType()->isStructTy()) ? P : nullptr;
-  }
-  else if (ExtractValueInst *EVI = dyn_cast<ExtractValueInst>(P)) {
-    for (unsigned Idx : EVI->indices())
-      IndexStack.push_back(Idx);
-
-    return EVI->getAggregateOperand();
-  }
-  else if (InsertValueInst *IVI = dyn_cast<InsertValueInst>(P)) {
-    for (unsigned Idx : IVI->indices())
-      IndexStack.push_back(Idx);
-
-    return IVI->getAggregateOperand();
-  }
-  return nullptr;
-}
-
-StructError *StructTreeWalker::navigateStructTree(StructTree *Root, bool Create) {
-  if (isa<StructError>(Root))
-    return cast<StructError>(Root);
-
-  StructNode *RN = cast<StructNode>(Root);
-  unsigned ChildIdx = IndexStack.back();
-  IndexStack.pop_back();
-
-  StructTree *Child = RN->getStructElement(ChildIdx);
-  if (Child != nullptr) {
-    return navigateStructTree(Child, Create);
-  }
-  else if (Create) {
-    Type *ChildType = RN->getStructType()->getElementType(ChildIdx);
-    while (SequentialType *STy = dyn_cast<SequentialType>(ChildType)) {
-      // Just discard array indices.
-      ChildType = STy->getElementType();
-      if (IndexStack.size() == 0) {
-	LLVM_DEBUG(dbgs() << "WARNING: struct tree shape mismatch.\n");
-	return nullptr;
-      }
-      IndexStack.pop_back();
-    }
-
-    if (StructType *ChildST = dyn_cast<StructType>(ChildType)) {
-      RN->setStructElement(ChildIdx, new StructNode(ChildST, Root));
-      return navigateStructTree(RN->getStructElement(ChildIdx), Create);
-    }
-    else {
-      RN->setStructElement(ChildIdx, new StructError(Root));
-      return cast<StructError>(RN->getStructElement(ChildIdx));
-    }
-  }
-  else
-    return nullptr;
-}
-
-unsigned StructTreeWalker::parseIndex(const Use &U) const {
-  if (ConstantInt *CIdx = dyn_cast<ConstantInt>(U.get()))
-    return CIdx->getZExtValue();
-  else
-    return 0U;
-}
-
 StructErrorMap::StructErrorMap(const StructErrorMap &M)
-  : StructMap(), ArgBindings(M.ArgBindings) {
-  for (auto &KV : M.StructMap) {
-    std::unique_ptr<StructTree> New(KV.second->clone());
-    this->StructMap.insert(std::make_pair(KV.first, std::move(New)));
-  }
-}
+  : StructMap(M.StructMap), ArgBindings(M.ArgBindings), Layouts(M.Layouts),
+    AccessPaths() {}
 
 StructErrorMap &StructErrorMap::operator=(const StructErrorMap &O) {
-  StructErrorMap Tmp(O);
-  std::swap(this->StructMap, Tmp.StructMap);
-  std::swap(this->ArgBindings, Tmp.ArgBindings);
+  this->StructMap = O.StructMap;
+  this->ArgBindings = O.ArgBindings;
+  this->Layouts = O.Layouts;
+  this->AccessPaths.clear();
 
   return *this;
 }
@@ -264,55 +152,61 @@ void StructErrorMap::initArgumentBindings(Function &F,
 
     ++AArgIt;
   }
+  // Accesses through arguments may be resolved differently now.
+  AccessPaths.clear();
 }
 
-void StructErrorMap::setFieldError(Value *P, const StructTree::RangeError &Err) {
-  StructTreeWalker STW(ArgBindings);
-  Value *RootP = STW.retrieveRootPointer(P);
-  if (RootP == nullptr)
+void StructErrorMap::setFieldError(Value *P, const RangeError &Err) {
+  FieldRef Ref = resolveAccess(P);
+  if (Ref.Root == nullptr)
     return;
 
-  auto RootIt = StructMap.find(RootP);
-  if (RootIt == StructMap.end()) {
-    RootIt = StructMap.insert(std::make_pair(RootP, std::unique_ptr<StructTree>(STW.makeRoot(RootP)))).first;
+  std::shared_ptr<SlotVector> &Slots = StructMap[Ref.Root];
+  if (Slots == nullptr) {
+    const StructFieldLayout *Layout = getRootLayout(Ref.Root);
+    assert(Layout != nullptr);
+    Slots = std::make_shared<SlotVector>(Layout->NumSlots);
+  }
+  else if (Slots.use_count() > 1) {
+    // Copy on write: the fields may be shared with other maps.
+    Slots = std::make_shared<SlotVector>(*Slots);
   }
 
-  StructError *FE = STW.getOrCreateFieldNode(RootIt->second.get());
-  if (FE) {
-    FE->setError(Err);
-  } else {
+  if (Ref.Slot < Slots->size())
+    (*Slots)[Ref.Slot] = Err;
+  else
     LLVM_DEBUG(dbgs() << "WARNING: could not retrieve struct field error.\n");
-  }
 }
 
-const StructTree::RangeError *StructErrorMap::getFieldError(Value *P) const {
-  StructTreeWalker STW(ArgBindings);
-  Value *RootP = STW.retrieveRootPointer(P);
-  if (RootP == nullptr)
+const StructErrorMap::RangeError *StructErrorMap::getFieldError(Value *P) const {
+  const FieldRef &Ref = resolveAccess(P);
+  if (Ref.Root == nullptr)
     return nullptr;
 
-  auto RootIt = StructMap.find(RootP);
+  auto RootIt = StructMap.find(Ref.Root);
   if (RootIt == StructMap.end())
     return nullptr;
 
-  StructError *FE = STW.getFieldNode(RootIt->second.get());
-  if (FE)
-    return &FE->getError();
+  const SlotVector &Slots = *RootIt->second;
+  if (Ref.Slot < Slots.size() && Slots[Ref.Slot].hasValue())
+    return Slots[Ref.Slot].getPointer();
   else
     return nullptr;
 }
 
 void StructErrorMap::updateStructTree(const StructErrorMap &O, const ArrayRef<Value *> Pointers) {
-  StructTreeWalker STW(this->ArgBindings);
+  SmallVector<unsigned, 4U> Indices;
   for (Value *P : Pointers) {
     if (P == nullptr || !P->getType()->isPointerTy())
       continue;
 
-    if (Value *Root = STW.retrieveRootPointer(P)) {
+    Indices.clear();
+    if (Value *Root = retrieveRootPointer(P, Indices)) {
       auto OTreeIt = O.StructMap.find(Root);
       if (OTreeIt != O.StructMap.end()
 	  && OTreeIt->second != nullptr)
-	this->StructMap[Root].reset(OTreeIt->second->clone());
+	// Share the fields, they will be copied if modified.
+	this->StructMap[Root] = OTreeIt->second;
     }
   }
 }
@@ -327,11 +221,211 @@ void StructErrorMap::createStructTreeFromMetadata(Value *V,
   else
     ST = cast<StructType>(taffo::fullyUnwrapPointerOrArrayType(V->getType()));
 
-  StructNode *RootSN = new StructNode(cast<StructInfo>(MDI), ST);
+  const StructFieldLayout *Layout = Layouts->getLayout(ST);
   // Erase previous data
-  StructMap[V].reset(RootSN);
+  std::shared_ptr<SlotVector> Slots = std::make_shared<SlotVector>(Layout->NumSlots);
+  fillFromMetadata(cast<StructInfo>(MDI), Layout, 0U, *Slots);
+  StructMap[V] = std::move(Slots);
 
   LLVM_DEBUG(dbgs() << ".\n");
 }
 
+size_t StructErrorMap::getMemoryUsage() const {
+  size_t Bytes = 0U;
+  for (const auto &Tree : StructMap) {
+    const std::shared_ptr<SlotVector> &Slots = Tree.second;
+    if (!Slots)
+      continue;
+
+    size_t SlotBytes = sizeof(SlotVector)
+      + Slots->capacity() * sizeof(SlotVector::value_type);
+    for (const Optional<RangeError> &Slot : *Slots)
+      if (Slot.hasValue() && Slot->second.hasValue())
+	SlotBytes += Slot->second->getMemoryUsage() - sizeof(AffineForm<inter_t>);
+    Bytes += SlotBytes / Slots.use_count();
+  }
+  return Bytes;
+}
+
+const StructErrorMap::FieldRef &StructErrorMap::resolveAccess(Value *P) const {
+  assert(P != nullptr);
+  auto Cached = AccessPaths.find(P);
+  if (Cached != AccessPaths.end())
+    return Cached->second;
+
+  FieldRef Ref;
+  Ref.Root = nullptr;
+  Ref.Slot = 0U;
+
+  SmallVector<unsigned, 4U> Indices;
+  Value *Root = retrieveRootPointer(P, Indices);
+  Type *T = (Root != nullptr) ? Root->getType() : nullptr;
+  unsigned Pos = 0U;
+  if (T != nullptr && stripToStruct(T, Indices, Pos)) {
+    const StructFieldLayout *L = Layouts->getLayout(cast<StructType>(T));
+    unsigned Slot = 0U;
+    unsigned SummaryBase = 0U;
+    while (Pos < Indices.size()) {
+      unsigned FieldIdx = Indices[Pos++];
+      if (FieldIdx >= L->NumFields)
+	break;
+
+      Slot += L->Offsets[FieldIdx];
+      const StructFieldLayout *FieldL = L->Nested[FieldIdx];
+      if (FieldL == nullptr) {
+	// Scalar field: further indices, if any, are ignored.
+	Ref.Root = Root;
+	Ref.Slot = Slot;
+	break;
+      }
+
+      Type *FieldT = L->Type->getElementType(FieldIdx);
+      if (!stripToStruct(FieldT, Indices, Pos))
+	break;
+
+      if (FieldL->IsSummary) {
+	if (FieldL == L)
+	  // Deeper nodes of a recursive type share the slots of the summary.
+	  Slot = SummaryBase;
+	else
+	  SummaryBase = Slot;
+      }
+      L = FieldL;
+    }
+  }
+
+  return AccessPaths[P] = Ref;
+}
+
+Value *StructErrorMap::retrieveRootPointer(Value *P,
+					   SmallVectorImpl<unsigned> &Indices) const {
+  // Indices are collected from the field to the root, then reversed.
+  Value *Root = nullptr;
+  while (P != nullptr) {
+    if (GetElementPtrInst *GEPI = dyn_cast<GetElementPtrInst>(P)) {
+      // Discard first index.
+      for (unsigned Op = GEPI->getNumOperands() - 1U; Op > 1U; --Op)
+	Indices.push_back(parseIndex(GEPI->getOperand(Op)));
+
+      P = GEPI->getPointerOperand();
+    }
+    else if (ConstantExpr *CE = dyn_cast<ConstantExpr>(P)) {
+      if (!CE->isGEPWithNoNotionalOverIndexing())
+	break;
+
+      assert(CE->getNumOperands() >= 2U);
+      for (unsigned Op = CE->getNumOperands() - 1U; Op > 1U; --Op)
+	Indices.push_back(parseIndex(CE->getOperand(Op)));
+
+      P = CE->getOperand(0U);
+      assert(P->getType()->isPointerTy());
+    }
+    else if (LoadInst *LI = dyn_cast<LoadInst>(P)) {
+      P = LI->getPointerOperand();
+    }
+    else if (Argument *A = dyn_cast<Argument>(P)) {
+      auto AArg = ArgBindings.find(A);
+      if (AArg != ArgBindings.end() && AArg->second != nullptr && AArg->second != A) {
+	P = AArg->second;
+      }
+      else {
+	if (isa<StructType>(cast<PointerType>(A->getType())->getElementType()))
+	  Root = P;
+	break;
+      }
+    }
+    else if (AllocaInst *AI = dyn_cast<AllocaInst>(P)) {
+      if (isa<StructType>(AI->getAllocatedType()))
+	Root = P;
+      break;
+    }
+    else if (GlobalVariable *GV = dyn_cast<GlobalVariable>(P)) {
+      if (GV->getValueType()->isStructTy())
+	Root = P;
+      break;
+    }
+    else if (ExtractValueInst *EVI = dyn_cast<ExtractValueInst>(P)) {
+      ArrayRef<unsigned> EVIdx = EVI->getIndices();
+      Indices.append(EVIdx.rbegin(), EVIdx.rend());
+      Root = EVI->getAggregateOperand();
+      break;
+    }
+    else if (InsertValueInst *IVI = dyn_cast<InsertValueInst>(P)) {
+      ArrayRef<unsigned> IVIdx = IVI->getIndices();
+      Indices.append(IVIdx.rbegin(), IVIdx.rend());
+      Root = IVI->getAggregateOperand();
+      break;
+    }
+    else
+      break;
+  }
+
+  std::reverse(Indices.begin(), Indices.end());
+  return Root;
+}
+
+const StructFieldLayout *StructErrorMap::getRootLayout(Value *Root) const {
+  StructType *ST = StructLayoutCache::getElementStructType(Root->getType());
+  return (ST != nullptr) ? Layouts->getLayout(ST) : nullptr;
+}
+
+void StructErrorMap::fillFromMetadata(const StructInfo *SI, const StructFieldLayout *Layout,
+				      unsigned Base, SlotVector &Slots) {
+  LLVM_DEBUG(dbgs() << "{ ");
+  for (std::size_t Idx = 0; Idx < SI->size() && Idx < Layout->NumFields; ++Idx) {
+    const MDInfo *FieldMDI = SI->getField(Idx);
+    if (FieldMDI == nullptr) {
+      LLVM_DEBUG(dbgs() << "null ,");
+      continue;
+    }
+
+    unsigned FieldBase = Base + Layout->Offsets[Idx];
+    const StructFieldLayout *FieldL = Layout->Nested[Idx];
+    if (FieldL == Layout) {
+      // Deeper nodes of a recursive type are summarized by this node.
+      LLVM_DEBUG(dbgs() << "recursive ,");
+      continue;
+    }
+    if (const StructInfo *FieldSI = dyn_cast<StructInfo>(FieldMDI)) {
+      if (FieldL != nullptr)
+	fillFromMetadata(FieldSI, FieldL, FieldBase, Slots);
+    }
+    else if (const InputInfo *FieldII = dyn_cast<InputInfo>(FieldMDI)) {
+      // Scalar data for a struct field hold for all its fields.
+      RangeError RE = makeRangeError(FieldII);
+      unsigned NumSlots = (FieldL != nullptr) ? FieldL->NumSlots : 1U;
+      for (unsigned S = FieldBase; S < FieldBase + NumSlots; ++S)
+	Slots[S] = RE;
+    }
+    else {
+      llvm_unreachable("Unhandled MDInfo kind.");
+    }
+    LLVM_DEBUG(dbgs() << ", ");
+  }
+  LLVM_DEBUG(dbgs() << "}");
+}
+
+unsigned StructErrorMap::parseIndex(const Value *Idx) {
+  if (const ConstantInt *CIdx = dyn_cast<ConstantInt>(Idx))
+    return CIdx->getZExtValue();
+  else
+    return 0U;
+}
+
+StructErrorMap::RangeError StructErrorMap::makeRangeError(const InputInfo *II) {
+  FPInterval FPI(II);
+
+  LLVM_DEBUG(dbgs() << "{Range: [" << static_cast<double>(FPI.Min) << ", "
+	<< static_cast<double>(FPI.Max) << "], Error: ");
+
+  if (FPI.hasInitialError()) {
+    LLVM_DEBUG(dbgs() << FPI.getInitialError() << "} ");
+    return std::make_pair(FPI, AffineForm<inter_t>(0.0, FPI.getInitialError()));
+  }
+  else {
+    LLVM_DEBUG(dbgs() << "none}");
+    return std::make_pair(FPI, NoneType());
+  }
+}
+
 } // end namespace ErrorProp
@@ -16,122 +16,107 @@
 #define ERRORPROPAGATOR_STRUCTERRORMAP_H
 
 #include <map>
+#include <memory>
+#include <vector>
+#include "llvm/Support/Allocator.h"
 #include "llvm/Support/Casting.h"
 #include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/ADT/DenseMap.h"
 #include "llvm/IR/Value.h"
 #include "llvm/IR/Argument.h"
+#include "llvm/IR/DerivedTypes.h"
 #include "FixedPoint.h"
 #include "Metadata.h"
 
 namespace ErrorProp {
 
-class StructTree {
-public:
-  typedef std::pair<FPInterval, llvm::Optional<AffineForm<inter_t> > > RangeError;
-  enum StructTreeKind {
-    STK_Node,
-    STK_Error
-  };
-
-  StructTree(StructTreeKind K, StructTree *P = nullptr)
-    : Parent(P), Kind(K) {}
-
-  virtual StructTree *clone() const = 0;
-  StructTree *getParent() const { return Parent; }
-  void setParent(StructTree *P) { Parent = P; }
-  virtual ~StructTree() = default;
-
-  StructTreeKind getKind() const { return Kind; }
-protected:
-  StructTree *Parent;
-
-private:
-  StructTreeKind Kind;
+/// Flat layout of the scalar fields of a struct type, in field order.
+/// Nested structs (also through arrays and pointers) are laid out in place,
+/// and all elements of an array share the same slots.
+/// A field that points back to an enclosing struct type is laid out
+/// as a summary of that type, with one slot for each of its fields,
+/// which is shared by all the deeper nodes of the recursive type.
+struct StructFieldLayout {
+  llvm::StructType *Type;
+  unsigned NumFields;
+  unsigned NumSlots;
+  /// True if this is the summary of a recursive type.
+  bool IsSummary;
+  /// First slot of each field.
+  unsigned *Offsets;
+  /// Layout of each struct field, nullptr for scalar fields.
+  const StructFieldLayout **Nested;
 };
 
-class StructNode : public StructTree {
+/// Builds and owns the layouts of struct types.
+class StructLayoutCache {
 public:
-  StructNode(llvm::StructType *ST, StructTree *Parent = nullptr)
-    : StructTree(STK_Node, Parent), Fields(), SType(ST) {
-    assert(ST != nullptr);
-    Fields.resize(ST->getNumElements());
-  }
-
-  StructNode(const mdutils::StructInfo *MDI, llvm::StructType *ST, StructTree *Parent = nullptr);
-  StructNode(const StructNode &SN);
-  StructNode &operator=(const StructNode &O);
-
-  StructTree *clone() const override { return new StructNode(*this); }
-  llvm::StructType *getStructType() const { return SType; }
-  StructTree *getStructElement(unsigned I) {
-    return (I < Fields.size()) ? Fields[I].get() : nullptr;
-  }
-
-  void setStructElement(unsigned I, StructTree *NewEl) { Fields[I].reset(NewEl); }
-
-  static bool classof(const StructTree *ST) { return ST->getKind() == STK_Node; }
-private:
-  llvm::SmallVector<std::unique_ptr<StructTree>, 2U> Fields;
-  llvm::StructType *SType;
+  const StructFieldLayout *getLayout(llvm::StructType *ST);
 
+  /// Strip pointer and array types from T, and return it if it is a struct.
   static llvm::StructType *getElementStructType(llvm::Type *T);
-};
-
-class StructError : public StructTree {
-public:
-  StructError(StructTree *Parent = nullptr)
-    : StructTree(STK_Error, Parent), Error() {}
-
-  StructError(const RangeError &Err, StructTree *Parent = nullptr)
-    : StructTree(STK_Error, Parent), Error(Err) {}
-
-  StructError(const mdutils::InputInfo *MDI,  StructTree *Parent = nullptr);
-
-  StructTree *clone() const override { return new StructError(*this); }
-  const RangeError& getError() const { return Error; }
-  void setError (const RangeError &Err) { Error = Err; }
 
-  static bool classof(const StructTree *ST) { return ST->getKind() == STK_Error; }
 private:
-  RangeError Error;
-};
-
-class StructTreeWalker {
-public:
-  StructTreeWalker(const llvm::DenseMap<llvm::Argument *, llvm::Value *> &ArgBindings)
-    : IndexStack(), ArgBindings(ArgBindings) {}
-
-  llvm::Value *retrieveRootPointer(llvm::Value *P);
-  StructError *getOrCreateFieldNode(StructTree *Root);
-  StructError *getFieldNode(StructTree *Root);
-  StructTree *makeRoot(llvm::Value *P);
+  llvm::BumpPtrAllocator Arena;
+  llvm::DenseMap<llvm::StructType *, const StructFieldLayout *> Layouts;
+  llvm::DenseMap<llvm::StructType *, const StructFieldLayout *> Summaries;
+  /// Struct types whose layout is being built, for recursive types.
+  llvm::SmallPtrSet<llvm::StructType *, 4U> InProgress;
 
-protected:
-  llvm::SmallVector<unsigned, 4U> IndexStack;
-  const llvm::DenseMap<llvm::Argument *, llvm::Value *> &ArgBindings;
-
-  llvm::Value *navigatePointerTreeToRoot(llvm::Value *P);
-  StructError *navigateStructTree(StructTree *Root, bool Create = false);
-  unsigned parseIndex(const llvm::Use &U) const;
+  const StructFieldLayout *getSummaryLayout(llvm::StructType *ST);
 };
 
+/// Maps struct variables to the ranges and errors of their fields.
+/// Fields of each struct are stored in a flat array, which is shared
+/// by copies of this map and copied only before being modified.
 class StructErrorMap {
 public:
-  StructErrorMap() = default;
+  typedef std::pair<FPInterval, llvm::Optional<AffineForm<inter_t> > > RangeError;
+
+  StructErrorMap()
+    : StructMap(), ArgBindings(), Layouts(std::make_shared<StructLayoutCache>()),
+      AccessPaths() {}
   StructErrorMap(const StructErrorMap &M);
   StructErrorMap &operator=(const StructErrorMap &O);
 
   void initArgumentBindings(llvm::Function &F, const llvm::ArrayRef<llvm::Value *> AArgs);
-  void setFieldError(llvm::Value *P, const StructTree::RangeError &Err);
-  const StructTree::RangeError *getFieldError(llvm::Value *P) const;
+  void setFieldError(llvm::Value *P, const RangeError &Err);
+  const RangeError *getFieldError(llvm::Value *P) const;
   void updateStructTree(const StructErrorMap &O, const llvm::ArrayRef<llvm::Value *> Pointers);
   void createStructTreeFromMetadata(llvm::Value *V,
 				    const mdutils::MDInfo *MDI);
 
+  /// Estimated bytes held by the field arrays of this map.
+  /// Arrays shared with other copies of the map are split among them.
+  size_t getMemoryUsage() const;
+
 protected:
-  std::map<llvm::Value *, std::unique_ptr<StructTree> > StructMap;
+  typedef std::vector<llvm::Optional<RangeError> > SlotVector;
+
+  /// A resolved struct field access.
+  struct FieldRef {
+    /// The struct variable, or nullptr if the access could not be resolved.
+    llvm::Value *Root;
+    unsigned Slot;
+  };
+
+  /// Fields of each struct variable, laid out as in StructFieldLayout.
+  std::map<llvm::Value *, std::shared_ptr<SlotVector> > StructMap;
   llvm::DenseMap<llvm::Argument *, llvm::Value *> ArgBindings;
+  std::shared_ptr<StructLayoutCache> Layouts;
+  /// Resolved accesses of each pointer.
+  /// It depends on ArgBindings, and it is not copied with the map.
+  mutable llvm::DenseMap<llvm::Value *, FieldRef> AccessPaths;
+
+  const FieldRef &resolveAccess(llvm::Value *P) const;
+  llvm::Value *retrieveRootPointer(llvm::Value *P,
+				   llvm::SmallVectorImpl<unsigned> &Indices) const;
+  const StructFieldLayout *getRootLayout(llvm::Value *Root) const;
+  void fillFromMetadata(const mdutils::StructInfo *SI, const StructFieldLayout *Layout,
+			unsigned Base, SlotVector &Slots);
+  static unsigned parseIndex(const llvm::Value *Idx);
+  static RangeError makeRangeError(const mdutils::InputInfo *II);
 };
 
 } // end namespace ErrorProp
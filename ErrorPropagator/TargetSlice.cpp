@@ -0,0 +1,249 @@
+//===-- TargetSlice.cpp - Backward slice of target variables ----*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// Interprocedural backward slice of the instructions and global variables
+/// marked as targets.
+///
+//===----------------------------------------------------------------------===//
+
+#include "TargetSlice.h"
+
+#include "llvm/IR/CallSite.h"
+#include "llvm/IR/InstIterator.h"
+#include "llvm/IR/Instructions.h"
+#include "llvm/IR/Operator.h"
+#include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/Support/Debug.h"
+
+#include "Metadata.h"
+
+namespace ErrorProp {
+
+using namespace llvm;
+using namespace mdutils;
+
+#define DEBUG_TYPE "errorprop"
+
+namespace {
+
+/// Strip casts and GEPs from pointer P.
+const Value *getBasePointer(const Value *P) {
+  P = P->stripPointerCasts();
+  while (const GEPOperator *GEP = dyn_cast<GEPOperator>(P))
+    P = GEP->getPointerOperand()->stripPointerCasts();
+  return P;
+}
+
+/// True if I may write to memory that is visible outside its function.
+bool mayWriteNonLocal(const Instruction &I) {
+  if (const StoreInst *SI = dyn_cast<StoreInst>(&I))
+    return !isa<AllocaInst>(getBasePointer(SI->getPointerOperand()));
+
+  ImmutableCallSite CS(&I);
+  if (!CS)
+    return false;
+  const Function *F = CS.getCalledFunction();
+  return F == nullptr || !F->isDeclaration();
+}
+
+} // end of anonymous namespace
+
+TargetSlice::TargetSlice(Pass &P, Module &M) {
+  indexCallSites(M);
+
+  // Seeds.
+  for (GlobalVariable &GV : M.globals())
+    if (MetadataManager::retrieveTargetMetadata(GV).hasValue())
+      addValue(&GV);
+  for (Function &F : M)
+    for (Instruction &I : instructions(F))
+      if (MetadataManager::retrieveTargetMetadata(I).hasValue())
+	addValue(&I);
+
+  while (!PendingFunctions.empty()) {
+    Function *F = PendingFunctions.pop_back_val();
+    if (Pending[F].empty())
+      continue;
+
+    MemorySSA &MSSA = P.getAnalysis<MemorySSAWrapperPass>(*F).getMSSA();
+    // Visiting may add instructions to F's own list.
+    while (!Pending[F].empty()) {
+      Instruction *I = Pending[F].pop_back_val();
+      visitInstruction(MSSA, *I);
+    }
+  }
+  Pending.clear();
+
+  computeReaching();
+
+  LLVM_DEBUG(dbgs() << "[taffo-err] Target slice: " << Values.size() << " values in "
+	     << Functions.size() << " functions, reached from "
+	     << Reaching.size() << " functions.\n");
+}
+
+bool TargetSlice::containsLoop(const Loop *L) const {
+  for (const BasicBlock *BB : L->blocks())
+    for (const Instruction &I : *BB)
+      if (isRelevant(I))
+	return true;
+  return false;
+}
+
+bool TargetSlice::isRelevant(const Instruction &I) const {
+  if (Values.count(&I))
+    return true;
+
+  // Calls must be processed to analyze their callees.
+  ImmutableCallSite CS(&I);
+  if (!CS)
+    return false;
+  const Function *F = CS.getCalledFunction();
+  return F != nullptr && Reaching.count(F);
+}
+
+void TargetSlice::indexCallSites(Module &M) {
+  for (Function &F : M)
+    for (Instruction &I : instructions(F)) {
+      CallSite CS(&I);
+      if (CS && CS.getCalledFunction() != nullptr)
+	CallSites[CS.getCalledFunction()].push_back(&I);
+    }
+}
+
+void TargetSlice::addValue(Value *V) {
+  if (isa<Instruction>(V) || isa<Argument>(V) || isa<GlobalVariable>(V)) {
+    if (!Values.insert(V).second)
+      return;
+  }
+
+  if (Instruction *I = dyn_cast<Instruction>(V)) {
+    Function *F = I->getFunction();
+    Functions.insert(F);
+    Pending[F].push_back(I);
+    PendingFunctions.insert(F);
+  }
+  else if (Argument *A = dyn_cast<Argument>(V)) {
+    for (Instruction *Call : CallSites.lookup(A->getParent())) {
+      CallSite CS(Call);
+      if (A->getArgNo() >= CS.arg_size())
+	continue;
+      addValue(CS.getArgument(A->getArgNo()));
+      // Stores before the call may define the pointed memory.
+      if (A->getType()->isPointerTy())
+	addValue(Call);
+    }
+  }
+  else if (GlobalVariable *GV = dyn_cast<GlobalVariable>(V)) {
+    addGlobalWriters(GV);
+  }
+  else if (ConstantExpr *CE = dyn_cast<ConstantExpr>(V)) {
+    for (Value *Op : CE->operands())
+      addValue(Op);
+  }
+}
+
+void TargetSlice::addGlobalWriters(GlobalVariable *GV) {
+  SmallVector<Value *, 8U> WL;
+  SmallPtrSet<Value *, 8U> Visited;
+  WL.push_back(GV);
+  while (!WL.empty()) {
+    Value *V = WL.pop_back_val();
+    if (!Visited.insert(V).second)
+      continue;
+
+    for (Use &U : V->uses()) {
+      User *Usr = U.getUser();
+      if (isa<StoreInst>(Usr)) {
+	if (U.getOperandNo() == StoreInst::getPointerOperandIndex())
+	  addValue(Usr);
+      }
+      else if (isa<GEPOperator>(Usr) || isa<BitCastOperator>(Usr)) {
+	WL.push_back(Usr);
+      }
+      else if (ImmutableCallSite(Usr)) {
+	// The callee may write through the pointer.
+	addValue(Usr);
+      }
+    }
+  }
+}
+
+void TargetSlice::addCalleeEffects(Function *F) {
+  if (F->isDeclaration() || !EffectsAdded.insert(F).second)
+    return;
+
+  for (Instruction &I : instructions(F))
+    if (isa<ReturnInst>(I) || mayWriteNonLocal(I))
+      addValue(&I);
+}
+
+void TargetSlice::addMemoryDependencies(MemorySSA &MSSA, Instruction &I) {
+  MemoryUseOrDef *MA = MSSA.getMemoryAccess(&I);
+  if (MA == nullptr)
+    return;
+
+  SmallVector<MemoryAccess *, 8U> WL;
+  SmallPtrSet<MemoryAccess *, 8U> Visited;
+  WL.push_back(isa<MemoryUse>(MA)
+	       ? MSSA.getWalker()->getClobberingMemoryAccess(MA)
+	       : MA->getDefiningAccess());
+  while (!WL.empty()) {
+    MemoryAccess *Clobber = WL.pop_back_val();
+    if (!Visited.insert(Clobber).second || MSSA.isLiveOnEntryDef(Clobber))
+      continue;
+
+    if (MemoryDef *MD = dyn_cast<MemoryDef>(Clobber)) {
+      addValue(MD->getMemoryInst());
+    }
+    else if (MemoryPhi *MPhi = dyn_cast<MemoryPhi>(Clobber)) {
+      for (Use &MU : MPhi->incoming_values())
+	WL.push_back(cast<MemoryAccess>(&MU));
+    }
+  }
+}
+
+void TargetSlice::visitInstruction(MemorySSA &MSSA, Instruction &I) {
+  for (Value *Op : I.operands())
+    if (!isa<Function>(Op))
+      addValue(Op);
+
+  if (isa<LoadInst>(I)) {
+    addMemoryDependencies(MSSA, I);
+    return;
+  }
+
+  CallSite CS(&I);
+  if (!CS)
+    return;
+
+  if (Function *F = CS.getCalledFunction())
+    addCalleeEffects(F);
+
+  for (Value *Arg : CS.args())
+    if (Arg->getType()->isPointerTy()) {
+      addMemoryDependencies(MSSA, I);
+      break;
+    }
+}
+
+void TargetSlice::computeReaching() {
+  SmallVector<const Function *, 8U> WL(Functions.begin(), Functions.end());
+  Reaching.insert(Functions.begin(), Functions.end());
+  while (!WL.empty()) {
+    const Function *F = WL.pop_back_val();
+    for (Instruction *Call : CallSites.lookup(F)) {
+      const Function *Caller = Call->getFunction();
+      if (Reaching.insert(Caller).second)
+	WL.push_back(Caller);
+    }
+  }
+}
+
+} // end of namespace ErrorProp
@@ -0,0 +1,90 @@
+//===-- TargetSlice.h - Backward slice of target variables ------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// Interprocedural backward slice of the instructions and global variables
+/// marked as targets, used to restrict error propagation to them.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef ERRORPROPAGATOR_TARGETSLICE_H
+#define ERRORPROPAGATOR_TARGETSLICE_H
+
+#include <map>
+#include "llvm/Pass.h"
+#include "llvm/IR/Module.h"
+#include "llvm/IR/Function.h"
+#include "llvm/IR/Instruction.h"
+#include "llvm/IR/GlobalVariable.h"
+#include "llvm/Analysis/LoopInfo.h"
+#include "llvm/Analysis/MemorySSA.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/DenseSet.h"
+#include "llvm/ADT/SetVector.h"
+#include "llvm/ADT/SmallVector.h"
+
+namespace ErrorProp {
+
+/// Computes the set of values on which target instructions
+/// and global variables depend, following operands,
+/// memory dependencies (through MemorySSA), call returns and pointer arguments.
+class TargetSlice {
+public:
+  /// Compute the slice of M. P is used to retrieve MemorySSA.
+  TargetSlice(llvm::Pass &P, llvm::Module &M);
+
+  /// True if no target has been found.
+  bool empty() const { return Values.empty(); }
+
+  /// True if V belongs to the slice.
+  bool contains(const llvm::Value *V) const { return Values.count(V); }
+
+  /// True if F contains instructions in the slice.
+  bool contains(const llvm::Function *F) const { return Functions.count(F); }
+
+  /// True if F contains instructions in the slice,
+  /// or if it (indirectly) calls a function that does.
+  bool reaches(const llvm::Function *F) const { return Reaching.count(F); }
+
+  /// True if L contains instructions in the slice,
+  /// or calls to functions that reach it.
+  bool containsLoop(const llvm::Loop *L) const;
+
+  /// True if instruction I must be processed.
+  bool isRelevant(const llvm::Instruction &I) const;
+
+  std::size_t size() const { return Values.size(); }
+
+protected:
+  llvm::DenseSet<const llvm::Value *> Values;
+  llvm::DenseSet<const llvm::Function *> Functions;
+  llvm::DenseSet<const llvm::Function *> Reaching;
+
+  /// Call sites of each function.
+  llvm::DenseMap<const llvm::Function *,
+		 llvm::SmallVector<llvm::Instruction *, 4U> > CallSites;
+  /// Functions whose side effects have already been added to the slice.
+  llvm::DenseSet<const llvm::Function *> EffectsAdded;
+
+  /// Instructions waiting to be visited, for each function.
+  std::map<llvm::Function *, llvm::SmallVector<llvm::Instruction *, 8U> > Pending;
+  llvm::SetVector<llvm::Function *> PendingFunctions;
+
+  void indexCallSites(llvm::Module &M);
+  void addValue(llvm::Value *V);
+  void addGlobalWriters(llvm::GlobalVariable *GV);
+  void addCalleeEffects(llvm::Function *F);
+  void addMemoryDependencies(llvm::MemorySSA &MSSA, llvm::Instruction &I);
+  void visitInstruction(llvm::MemorySSA &MSSA, llvm::Instruction &I);
+  void computeReaching();
+};
+
+} // end namespace ErrorProp
+
+#endif
@@ -0,0 +1,428 @@
+//===-- VectorPropagators.cpp - Vector Instruction Propagators --*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// Definitions of functions that propagate fixed point computation errors
+/// lane by lane for instructions on fixed-width vectors.
+///
+//===----------------------------------------------------------------------===//
+
+#include "Propagators.h"
+
+#include <algorithm>
+#include <limits>
+#include "llvm/ADT/StringSwitch.h"
+#include "llvm/IR/Constants.h"
+#include "llvm/IR/DerivedTypes.h"
+#include "llvm/IR/Instructions.h"
+#include "llvm/Support/Debug.h"
+
+namespace ErrorProp {
+
+#define DEBUG_TYPE "errorprop"
+
+using namespace llvm;
+
+namespace {
+
+typedef RangeErrorMap::RangeError RangeError;
+
+enum VectorReductionKind {
+  VRK_None,
+  VRK_Add,
+  VRK_Mul,
+  VRK_MinMax
+};
+
+VectorReductionKind getVectorReductionKind(StringRef Name) {
+  if (!Name.consume_front("llvm.vector.reduce.")
+      && !Name.consume_front("llvm.experimental.vector.reduce."))
+    return VRK_None;
+
+  // Ordered floating point reductions had a v2 prefix in older releases.
+  Name.consume_front("v2.");
+  return StringSwitch<VectorReductionKind>(Name.split('.').first)
+    .Cases("add", "fadd", VRK_Add)
+    .Cases("mul", "fmul", VRK_Mul)
+    .Cases("smax", "smin", "umax", "umin", VRK_MinMax)
+    .Cases("fmax", "fmin", "fmaximum", "fminimum", VRK_MinMax)
+    .Default(VRK_None);
+}
+
+FPInterval getNaNInterval() {
+  return FPInterval(Interval<inter_t>(std::numeric_limits<inter_t>::quiet_NaN(),
+				      std::numeric_limits<inter_t>::quiet_NaN()));
+}
+
+/// Join two lanes that may flow into the same lane,
+/// taking the largest error and the union of the known ranges.
+RangeError joinLanes(const RangeError &A, const RangeError &B) {
+  assert(A.second.hasValue() && B.second.hasValue());
+  AffineForm<inter_t> Err(0.0, std::max(A.second->noiseTermsAbsSum(),
+					B.second->noiseTermsAbsSum()));
+  if (!B.first.hasBounds() || A.first == B.first)
+    return RangeError(A.first, Err);
+  if (!A.first.hasBounds())
+    return RangeError(B.first, Err);
+
+  FPInterval R(Interval<inter_t>(std::min(A.first.Min, B.first.Min),
+				 std::max(A.first.Max, B.first.Max)));
+  return RangeError(R, Err);
+}
+
+FPInterval addRanges(const FPInterval &A, const FPInterval &B) {
+  return FPInterval(Interval<inter_t>(A.Min + B.Min, A.Max + B.Max));
+}
+
+FPInterval multiplyRanges(const FPInterval &A, const FPInterval &B) {
+  if (std::isnan(A.Min) || std::isnan(A.Max)
+      || std::isnan(B.Min) || std::isnan(B.Max))
+    return getNaNInterval();
+
+  inter_t P[4] = { A.Min * B.Min, A.Min * B.Max, A.Max * B.Min, A.Max * B.Max };
+  return FPInterval(Interval<inter_t>(*std::min_element(P, P + 4),
+				      *std::max_element(P, P + 4)));
+}
+
+/// True if V is the identity element of reductions of kind Kind.
+bool isReductionIdentity(const Value *V, VectorReductionKind Kind) {
+  const ConstantFP *CFP = dyn_cast<ConstantFP>(V);
+  if (CFP == nullptr)
+    return false;
+
+  return (Kind == VRK_Add && CFP->isZero())
+    || (Kind == VRK_Mul && CFP->isExactlyValue(1.0));
+}
+
+} // end of anonymous namespace
+
+unsigned InstructionPropagator::getNumLanes(const Type *T) {
+  const VectorType *VT = dyn_cast<VectorType>(T);
+  if (VT == nullptr || VT->isScalable())
+    return 0U;
+
+  return VT->getNumElements();
+}
+
+RangeError InstructionPropagator::getEmptyLane() {
+  return RangeError(getNaNInterval(), NoneType());
+}
+
+RangeError InstructionPropagator::makeLane(Instruction &I,
+					   const AffineForm<inter_t> &Err,
+					   const FPInterval *SrcR) {
+  const FPInterval *ResR = RMap.getRange(&I);
+  if (ResR != nullptr && !ResR->isUninitialized())
+    return RangeError(*ResR, Err);
+  if (SrcR != nullptr)
+    return RangeError(*SrcR, Err);
+
+  return RangeError(getNaNInterval(), Err);
+}
+
+bool InstructionPropagator::setLaneErrors(Instruction &I, ArrayRef<RangeError> Lanes) {
+  RMap.setLaneRangeErrors(&I, Lanes);
+
+  bool HasError = false;
+  for (const RangeError &Lane : Lanes)
+    HasError |= Lane.second.hasValue();
+
+  if (!HasError) {
+    LLVM_DEBUG(logInfoln("no data."));
+    return false;
+  }
+
+  LLVM_DEBUG(dbgs() << "(lanes:";
+	     for (const RangeError &Lane : Lanes) {
+	       dbgs() << " ";
+	       logError(Lane);
+	     }
+	     dbgs() << ") ";
+	     logErrorln(*RMap.getError(&I)));
+  return true;
+}
+
+bool InstructionPropagator::isVectorReduction(Function &F) {
+  return F.isIntrinsic() && getVectorReductionKind(F.getName()) != VRK_None;
+}
+
+bool InstructionPropagator::propagateVectorBinaryOp(Instruction &I) {
+  LLVM_DEBUG(logInstruction(I));
+
+  unsigned Opcode = I.getOpcode();
+  bool DoublePP = Opcode == Instruction::UDiv
+    || Opcode == Instruction::SDiv;
+  const FPInterval *ResR = RMap.getRange(&I);
+  unsigned NumLanes = getNumLanes(I.getType());
+  SmallVector<RangeError, 4U> Lanes;
+  Lanes.reserve(NumLanes);
+  for (unsigned Lane = 0U; Lane < NumLanes; ++Lane) {
+    auto *O1 = getOperandLaneRangeError(I, I.getOperand(0U), Lane, DoublePP);
+    auto *O2 = getOperandLaneRangeError(I, I.getOperand(1U), Lane);
+    if (O1 == nullptr || !O1->second.hasValue()
+	|| O2 == nullptr || !O2->second.hasValue()) {
+      Lanes.push_back(getEmptyLane());
+      continue;
+    }
+
+    AffineForm<inter_t> ERes;
+    if (!computeBinaryOpError(Opcode, *O1, *O2, ResR, ERes))
+      return false;
+
+    Lanes.push_back(makeLane(I, ERes));
+  }
+
+  return setLaneErrors(I, Lanes);
+}
+
+bool InstructionPropagator::propagateVectorSelect(Instruction &I) {
+  SelectInst &SI = cast<SelectInst>(I);
+
+  LLVM_DEBUG(logInstruction(I));
+
+  // Each lane may come from either operand, whatever the condition.
+  unsigned NumLanes = getNumLanes(I.getType());
+  SmallVector<RangeError, 4U> Lanes;
+  Lanes.reserve(NumLanes);
+  for (unsigned Lane = 0U; Lane < NumLanes; ++Lane) {
+    auto *TV = getOperandLaneRangeError(I, SI.getTrueValue(), Lane);
+    auto *FV = getOperandLaneRangeError(I, SI.getFalseValue(), Lane);
+    if (TV == nullptr || !TV->second.hasValue()
+	|| FV == nullptr || !FV->second.hasValue()) {
+      Lanes.push_back(getEmptyLane());
+      continue;
+    }
+
+    RangeError Joined = joinLanes(*TV, *FV);
+    Lanes.push_back(makeLane(I, *Joined.second, &Joined.first));
+  }
+
+  return setLaneErrors(I, Lanes);
+}
+
+bool InstructionPropagator::propagateVectorPhi(Instruction &I) {
+  PHINode &PHI = cast<PHINode>(I);
+
+  LLVM_DEBUG(logInstruction(I));
+
+  unsigned NumLanes = getNumLanes(I.getType());
+  SmallVector<RangeError, 4U> Lanes;
+  Lanes.reserve(NumLanes);
+  for (unsigned Lane = 0U; Lane < NumLanes; ++Lane) {
+    // Incoming values with no error are skipped, as for scalars.
+    Optional<RangeError> Joined;
+    for (const Use &IVal : PHI.incoming_values()) {
+      auto *RE = getOperandLaneRangeError(I, IVal, Lane);
+      if (RE == nullptr || !RE->second.hasValue())
+	continue;
+
+      if (Joined.hasValue())
+	Joined = joinLanes(*Joined, *RE);
+      else
+	Joined = *RE;
+    }
+
+    if (Joined.hasValue())
+      Lanes.push_back(makeLane(I, AffineForm<inter_t>(0.0, Joined->second->noiseTermsAbsSum()),
+			       &Joined->first));
+    else
+      Lanes.push_back(getEmptyLane());
+  }
+
+  return setLaneErrors(I, Lanes);
+}
+
+bool InstructionPropagator::lanesPassThrough(Instruction &I, inter_t RoundingError) {
+  unsigned NumLanes = getNumLanes(I.getType());
+  SmallVector<RangeError, 4U> Lanes;
+  Lanes.reserve(NumLanes);
+  for (unsigned Lane = 0U; Lane < NumLanes; ++Lane) {
+    auto *OpRE = getOperandLaneRangeError(I, I.getOperand(0U), Lane);
+    if (OpRE == nullptr || !OpRE->second.hasValue()) {
+      Lanes.push_back(getEmptyLane());
+      continue;
+    }
+
+    AffineForm<inter_t> Err = *OpRE->second;
+    if (RoundingError > 0.0)
+      // Each lane is rounded independently.
+      Err = Err + AffineForm<inter_t>(0.0, RoundingError);
+
+    Lanes.push_back(makeLane(I, Err, &OpRE->first));
+  }
+
+  return setLaneErrors(I, Lanes);
+}
+
+bool InstructionPropagator::propagateExtractElement(Instruction &I) {
+  ExtractElementInst &EEI = cast<ExtractElementInst>(I);
+
+  LLVM_DEBUG(logInstruction(I));
+
+  Value *Vec = EEI.getVectorOperand();
+  const RangeError *LaneRE = nullptr;
+  ConstantInt *CIdx = dyn_cast<ConstantInt>(EEI.getIndexOperand());
+  if (CIdx != nullptr && CIdx->getValue().ult(getNumLanes(Vec->getType())))
+    LaneRE = getOperandLaneRangeError(I, Vec, CIdx->getZExtValue());
+  else
+    // Any lane may be extracted: the error of the whole vector is the largest.
+    LaneRE = getOperandRangeError(I, Vec);
+
+  if (LaneRE == nullptr || !LaneRE->second.hasValue()) {
+    LLVM_DEBUG(logInfoln("no data."));
+    return false;
+  }
+  RangeError RE = *LaneRE;
+
+  const FPInterval *ResR = RMap.getRange(&I);
+  if (ResR != nullptr && !ResR->isUninitialized())
+    RMap.setError(&I, *RE.second);
+  else
+    RMap.setRangeError(&I, RE);
+
+  LLVM_DEBUG(logErrorln(RE));
+
+  return true;
+}
+
+bool InstructionPropagator::propagateInsertElement(Instruction &I) {
+  InsertElementInst &IEI = cast<InsertElementInst>(I);
+
+  LLVM_DEBUG(logInstruction(I));
+
+  unsigned NumLanes = getNumLanes(I.getType());
+  if (NumLanes == 0U) {
+    LLVM_DEBUG(logInfoln("not supported (scalable vector)."));
+    return false;
+  }
+
+  auto *EltRE = getOperandRangeError(I, IEI.getOperand(1U));
+  RangeError NewLane = (EltRE != nullptr) ? *EltRE : getEmptyLane();
+
+  ConstantInt *CIdx = dyn_cast<ConstantInt>(IEI.getOperand(2U));
+  SmallVector<RangeError, 4U> Lanes;
+  Lanes.reserve(NumLanes);
+  for (unsigned Lane = 0U; Lane < NumLanes; ++Lane) {
+    if (CIdx != nullptr && CIdx->getValue() == Lane) {
+      Lanes.push_back(NewLane);
+      continue;
+    }
+
+    auto *OldRE = getOperandLaneRangeError(I, IEI.getOperand(0U), Lane);
+    RangeError OldLane = (OldRE != nullptr) ? *OldRE : getEmptyLane();
+    if (CIdx == nullptr) {
+      // The new element may be inserted in any lane.
+      if (OldLane.second.hasValue() && NewLane.second.hasValue())
+	OldLane = joinLanes(OldLane, NewLane);
+      else
+	OldLane = getEmptyLane();
+    }
+    Lanes.push_back(OldLane);
+  }
+
+  return setLaneErrors(I, Lanes);
+}
+
+bool InstructionPropagator::propagateShuffleVector(Instruction &I) {
+  ShuffleVectorInst &SVI = cast<ShuffleVectorInst>(I);
+
+  LLVM_DEBUG(logInstruction(I));
+
+  unsigned NumSrcLanes = getNumLanes(SVI.getOperand(0U)->getType());
+  if (NumSrcLanes == 0U || getNumLanes(I.getType()) == 0U) {
+    LLVM_DEBUG(logInfoln("not supported (scalable vector)."));
+    return false;
+  }
+
+  SmallVector<int, 16U> Mask;
+  SVI.getShuffleMask(Mask);
+  SmallVector<RangeError, 4U> Lanes;
+  Lanes.reserve(Mask.size());
+  for (int M : Mask) {
+    const RangeError *SrcRE = nullptr;
+    if (M >= 0) {
+      unsigned SrcLane = static_cast<unsigned>(M);
+      Value *Src = SVI.getOperand((SrcLane < NumSrcLanes) ? 0U : 1U);
+      SrcRE = getOperandLaneRangeError(I, Src, SrcLane % NumSrcLanes);
+    }
+    Lanes.push_back((SrcRE != nullptr) ? *SrcRE : getEmptyLane());
+  }
+
+  return setLaneErrors(I, Lanes);
+}
+
+bool InstructionPropagator::propagateVectorReduction(Instruction &I, Function &Called) {
+  VectorReductionKind Kind = getVectorReductionKind(Called.getName());
+  assert(Kind != VRK_None);
+  LLVM_DEBUG(logInfo("(vector reduction)"));
+
+  CallInst &CI = cast<CallInst>(I);
+  Value *Vec = CI.getArgOperand(CI.arg_size() - 1U);
+  unsigned NumLanes = getNumLanes(Vec->getType());
+  if (NumLanes == 0U) {
+    LLVM_DEBUG(logInfoln("not supported (scalable vector)."));
+    return false;
+  }
+
+  // Ordered floating point reductions also take a start value.
+  Optional<RangeError> Acc;
+  if (CI.arg_size() > 1U && !isReductionIdentity(CI.getArgOperand(0U), Kind)) {
+    auto *StartRE = getOperandRangeError(I, CI.getArgOperand(0U));
+    if (StartRE == nullptr || !StartRE->second.hasValue()) {
+      LLVM_DEBUG(logInfoln("no data."));
+      return false;
+    }
+    Acc = *StartRE;
+  }
+
+  for (unsigned Lane = 0U; Lane < NumLanes; ++Lane) {
+    auto *LaneRE = getOperandLaneRangeError(I, Vec, Lane);
+    if (LaneRE == nullptr || !LaneRE->second.hasValue()) {
+      LLVM_DEBUG(logInfoln("no data."));
+      return false;
+    }
+
+    if (!Acc.hasValue()) {
+      Acc = *LaneRE;
+      continue;
+    }
+
+    switch (Kind) {
+      case VRK_Add:
+	Acc = RangeError(addRanges(Acc->first, LaneRE->first),
+			 *Acc->second + *LaneRE->second);
+	break;
+      case VRK_Mul: {
+	AffineForm<inter_t> ERes;
+	computeBinaryOpError(Instruction::Mul, *Acc, *LaneRE, nullptr, ERes);
+	Acc = RangeError(multiplyRanges(Acc->first, LaneRE->first), ERes);
+	break;
+      }
+      case VRK_MinMax:
+	Acc = joinLanes(*Acc, *LaneRE);
+	break;
+      default:
+	llvm_unreachable("Unknown vector reduction.");
+    }
+  }
+  assert(Acc.hasValue());
+  RangeError RE = *Acc;
+
+  const FPInterval *ResR = RMap.getRange(&I);
+  if (ResR != nullptr && !ResR->isUninitialized())
+    RMap.setError(&I, *RE.second);
+  else
+    RMap.setRangeError(&I, RE);
+
+  LLVM_DEBUG(logErrorln(RE));
+
+  return true;
+}
+
+} // end of namespace ErrorProp
@@ -1,5 +1,7 @@
 #!/usr/bin/env python3
 import argparse
+import json
+import math
 import pickle
 import sys
 from copy import copy
@@ -16,8 +18,28 @@ def parse_perfest(fpath):
     return float(text.strip())
 
 
+def parse_report_error(value):
+    # non-finite errors are written as "inf", "-inf" or "nan";
+    # an undefined error is no bound at all
+    err = float(value)
+    return float('inf') if math.isnan(err) else err
+
+
+def parse_errorprop_report(lines):
+    errors = []
+    for line in lines:
+        record = json.loads(line)
+        if record.get('kind') == 'target':
+            errors.append(parse_report_error(record['error']))
+    return errors
+
+
 def parse_errorprop(fpath):
     text = fpath.read_text().splitlines()
+    if len(text) > 0 and text[0].startswith('{'):
+        # report written with -errorprop-report
+        errors = parse_errorprop_report(text)
+        return 0 if len(errors) == 0 else max(errors)
     errors = []
     for line in text:
         if not line.startswith('Computed error'):
@@ -138,7 +160,7 @@ class FeedbackEstimatorState:
 if __name__ == "__main__":
     parser = argparse.ArgumentParser(description='TAFFO Feedback Estimator Experimental Tool. Outputs on stdout the command line parameters to DTA for the next compilation or STOP if the compilation loop should be interrupted.')
     parser.add_argument('--pe-out', '-p', type=str, help='file containing the output of the performance estimator')
-    parser.add_argument('--ep-out', '-e', type=str, help='file containing the output of the error propagator')
+    parser.add_argument('--ep-out', '-e', type=str, help='file containing the output or the -errorprop-report of the error propagator')
     parser.add_argument('--pe-val', type=int)
     parser.add_argument('--ep-val', type=float)
     parser.add_argument('--init', '-i', action='store_true', help='initialize the state for a new compilation')
@@ -0,0 +1,251 @@
+#!/usr/bin/env python3
+# Scalability benchmark for the error propagator.
+# Usage:
+#   benchmark.py run --opt <opt> --lib <LLVMErrorPropagator.so> [-o results.json]
+#                [--suite suite.json] [--cases <regex>] [--repeat N] [--timeout S]
+#                [--workdir DIR] [--baseline baseline.json]
+#   benchmark.py compare <baseline.json> <results.json> [--threshold F]
+# run generates each case of the suite with stressgen.py, runs the pass on it,
+# and records wall time, peak RSS and noise term statistics of each case.
+# compare reports the cases that got slower, bigger or failed,
+# and exits with status 1 if there are any.
+import argparse
+import datetime
+import json
+import os
+import platform
+import re
+import statistics
+import subprocess
+import sys
+import threading
+import time
+
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+import stressgen
+
+DEFAULT_SUITE = os.path.join(os.path.dirname(os.path.abspath(__file__)), 'suite.json')
+
+# Metrics compared between runs, and whether they are measured (noisy)
+# or computed by the pass (deterministic).
+METRICS = [
+    ('seconds', True),
+    ('maxrss_kb', True),
+    ('maxnoiseterms', False),
+    ('noiseterms', False),
+    ('symbols', False),
+    ('mapentries', False),
+    ('bytes', False),
+]
+
+# Differences in time below this many seconds are not reported.
+MIN_SECONDS = 0.05
+
+
+def run_pass(cmd, log, timeout):
+    """Run cmd with stderr to log, and return (exit status, seconds, maxrss in KiB).
+    The exit status is None if the process has been killed after timeout seconds."""
+    with open(log, 'w') as err:
+        start = time.perf_counter()
+        proc = subprocess.Popen(cmd, stdout=subprocess.DEVNULL, stderr=err)
+        timer = None
+        timed_out = []
+        if timeout:
+            def kill():
+                timed_out.append(True)
+                proc.kill()
+            timer = threading.Timer(timeout, kill)
+            timer.start()
+        _, status, usage = os.wait4(proc.pid, 0)
+        seconds = time.perf_counter() - start
+        if timer:
+            timer.cancel()
+        # Let Popen know that the process has been waited for.
+        if os.WIFSIGNALED(status):
+            proc.returncode = -os.WTERMSIG(status)
+        else:
+            proc.returncode = os.WEXITSTATUS(status)
+    maxrss = usage.ru_maxrss
+    if sys.platform == 'darwin':
+        maxrss //= 1024
+    return (None if timed_out else proc.returncode), seconds, maxrss
+
+
+def read_report(path):
+    """Summarize the telemetry records of an -errorprop-report file."""
+    res = {'errors': 0, 'noiseterms': 0, 'maxnoiseterms': 0, 'targets': 0}
+    with open(path) as f:
+        for line in f:
+            record = json.loads(line)
+            kind = record.get('kind')
+            if kind == 'target':
+                res['targets'] += 1
+            elif kind == 'noiseterms' and 'opcode' in record:
+                res['errors'] += record['errors']
+                res['noiseterms'] += record['noiseterms']
+                res['maxnoiseterms'] = max(res['maxnoiseterms'], record['maxnoiseterms'])
+            elif kind == 'memory':
+                for key in ('symbols', 'mapentries', 'affinebytes', 'structbytes',
+                            'copybytes', 'bytes'):
+                    res[key] = record[key]
+    return res
+
+
+def run_case(case, args):
+    name = case['name']
+    ll = os.path.join(args.workdir, name + '.ll')
+    report = os.path.join(args.workdir, name + '.jsonl')
+    log = os.path.join(args.workdir, name + '.log')
+    with open(ll, 'w') as f:
+        f.write(stressgen.generate(case['kind'], case['size'],
+                                   case.get('trip', 16), case.get('width', 8)))
+
+    cmd = [args.opt, '-load', args.lib, '-errorprop',
+           '-errorprop-report=' + report, '-errtelemetry']
+    cmd += case.get('options', [])
+    cmd += ['-disable-output', ll]
+
+    res = {key: case[key] for key in ('kind', 'size', 'trip', 'width', 'options')
+           if key in case}
+    times = []
+    maxrss = 0
+    for _ in range(args.repeat):
+        status, seconds, rss = run_pass(cmd, log, args.timeout)
+        if status != 0:
+            res['status'] = 'timeout' if status is None else 'error'
+            res['seconds'] = seconds
+            return res
+        times.append(seconds)
+        maxrss = max(maxrss, rss)
+
+    res['status'] = 'ok'
+    res['seconds'] = min(times)
+    res['seconds_median'] = statistics.median(times)
+    res['maxrss_kb'] = maxrss
+    res.update(read_report(report))
+    return res
+
+
+def run(args):
+    with open(args.suite) as f:
+        suite = json.load(f)
+    if args.cases:
+        suite = [c for c in suite if re.search(args.cases, c['name'])]
+    os.makedirs(args.workdir, exist_ok=True)
+
+    results = {
+        'version': 1,
+        'date': datetime.datetime.now().isoformat(timespec='seconds'),
+        'host': platform.node(),
+        'opt': args.opt,
+        'lib': args.lib,
+        'repeat': args.repeat,
+        'cases': {},
+    }
+    failed = 0
+    for case in suite:
+        res = run_case(case, args)
+        results['cases'][case['name']] = res
+        if res['status'] != 'ok':
+            failed += 1
+        print('%-24s %-8s %8.3f s %10s KiB %8s terms' % (
+            case['name'], res['status'], res['seconds'], res.get('maxrss_kb', '-'),
+            res.get('maxnoiseterms', '-')))
+        sys.stdout.flush()
+
+    text = json.dumps(results, indent=2, sort_keys=True) + '\n'
+    if args.output == '-':
+        sys.stdout.write(text)
+    else:
+        with open(args.output, 'w') as f:
+            f.write(text)
+
+    status = 1 if failed else 0
+    if args.baseline:
+        with open(args.baseline) as f:
+            status = max(status, compare_results(json.load(f), results, args.threshold))
+    return status
+
+
+def compare_results(base, cur, threshold):
+    """Print the changes from base to cur, and return 1 if something got worse."""
+    worse = 0
+    print('%-24s %-14s %14s %14s %8s' % ('Case', 'Metric', 'Baseline', 'Current', 'Change'))
+    for name in sorted(set(base['cases']) | set(cur['cases'])):
+        b = base['cases'].get(name)
+        c = cur['cases'].get(name)
+        if b is None or c is None:
+            print('%-24s %s' % (name, 'new case' if b is None else 'missing'))
+            continue
+        if c['status'] != 'ok' or b['status'] != 'ok':
+            if c['status'] != b['status']:
+                print('%-24s %-14s %14s %14s' % (name, 'status', b['status'], c['status']))
+                if c['status'] != 'ok':
+                    worse = 1
+            continue
+        for metric, measured in METRICS:
+            if metric not in b or metric not in c:
+                continue
+            old, new = b[metric], c[metric]
+            if old == new:
+                continue
+            change = (new - old) / old if old else float('inf')
+            mark = ''
+            if change > threshold and not (metric == 'seconds' and new - old < MIN_SECONDS):
+                mark = ' *'
+                worse = 1
+            elif measured and abs(change) <= threshold:
+                continue
+            print('%-24s %-14s %14s %14s %+7.1f%%%s' % (
+                name, metric, fmt(old), fmt(new), change * 100, mark))
+    if worse:
+        print('Regressions above %.0f%% are marked with *.' % (threshold * 100))
+    return worse
+
+
+def fmt(value):
+    return '%.3f' % value if isinstance(value, float) else str(value)
+
+
+def compare(args):
+    with open(args.baseline) as f:
+        base = json.load(f)
+    with open(args.current) as f:
+        cur = json.load(f)
+    return compare_results(base, cur, args.threshold)
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Error propagator scalability benchmark.')
+    sub = parser.add_subparsers(dest='command')
+    sub.required = True
+
+    prun = sub.add_parser('run', help='run the benchmark')
+    prun.add_argument('--opt', required=True, help='opt executable')
+    prun.add_argument('--lib', required=True, help='error propagator plugin')
+    prun.add_argument('--suite', default=DEFAULT_SUITE, help='cases to run (JSON)')
+    prun.add_argument('--cases', default='', help='only run cases matching this regex')
+    prun.add_argument('--repeat', type=int, default=3, help='runs of each case')
+    prun.add_argument('--timeout', type=float, default=600,
+                      help='seconds before a run is killed (0: none)')
+    prun.add_argument('--workdir', default='benchmark-cases',
+                      help='directory for generated cases, reports and logs')
+    prun.add_argument('-o', dest='output', default='benchmark.json', help='results file')
+    prun.add_argument('--baseline', help='compare the results with this file')
+    prun.add_argument('--threshold', type=float, default=0.1,
+                      help='relative increase reported as a regression')
+    prun.set_defaults(func=run)
+
+    pcmp = sub.add_parser('compare', help='compare two results files')
+    pcmp.add_argument('baseline')
+    pcmp.add_argument('current')
+    pcmp.add_argument('--threshold', type=float, default=0.1,
+                      help='relative increase reported as a regression')
+    pcmp.set_defaults(func=compare)
+
+    args = parser.parse_args()
+    sys.exit(args.func(args))
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,255 @@
+#!/usr/bin/env python3
+# Generate parameterized stress cases for the error propagator,
+# as LLVM IR with TAFFO range and error metadata.
+# Usage: stressgen.py <kind> <size> [--trip N] [--width N] [-o FILE]
+#   callchain <n>: a chain of n functions, each calling the next one
+#   fanout <n>:    a function calling n different functions
+#   loops <n>:     n nested loops, with --trip iterations each
+#   struct <n>:    n nested structs, with --width fields each, passed to a callee
+#   depchain <n>:  a chain of n dependent instructions
+#   targets <n>:   n independent computations, each marked as a target
+# The root function of each case is marked as a starting point.
+import argparse
+import sys
+
+HEADER = """target datalayout = "e-m:e-i64:64-f80:128-n8:16:32:64-S128"
+target triple = "x86_64-unknown-linux-gnu"
+
+"""
+
+KINDS = ['callchain', 'fanout', 'loops', 'struct', 'depchain', 'targets']
+
+
+class Module:
+    """Collects functions and uniqued metadata nodes of a module."""
+
+    def __init__(self):
+        self.types = []
+        self.functions = []
+        self.md = []
+        self.mdids = {}
+        fixp = self.node('!{!"fixp", i32 -32, i32 16}')
+        # Arguments have a small range and an initial error,
+        # computed values a larger range and no initial error.
+        self.arg = self.node('!{%s, %s, %s}' % (
+            fixp, self.node('!{double -1.000000e+00, double 1.000000e+00}'),
+            self.node('!{double 1.000000e-05}')))
+        self.val = self.node('!{%s, %s, i1 0}' % (
+            fixp, self.node('!{double -1.000000e+03, double 1.000000e+03}')))
+        self.start = self.node('!{i1 true}')
+
+    def node(self, text):
+        if text not in self.mdids:
+            self.mdids[text] = len(self.md)
+            self.md.append(text)
+        return '!%d' % self.mdids[text]
+
+    def funinfo(self, args):
+        """args: for each argument, its input info node or None."""
+        return self.node('!{%s}' % ', '.join(
+            'i32 0, i32 0' if a is None else 'i32 1, %s' % a for a in args))
+
+    def target(self, name):
+        return self.node('!{!"%s"}' % name)
+
+    def define(self, name, body, root=False, params='i32 %a, i32 %b', args=None):
+        if args is None:
+            args = [self.arg, self.arg]
+        attach = ' !taffo.funinfo %s' % self.funinfo(args)
+        if root:
+            attach += ' !taffo.start %s' % self.start
+        self.functions.append('define i32 @%s(%s)%s {\n%s}\n'
+                              % (name, params, attach, ''.join(body)))
+
+    def text(self):
+        out = [HEADER]
+        out.extend(self.types)
+        if self.types:
+            out.append('\n')
+        out.append('\n'.join(self.functions))
+        out.append('\n')
+        out.extend('!%d = %s\n' % (i, n) for i, n in enumerate(self.md))
+        return ''.join(out)
+
+
+def gen_callchain(m, n, args):
+    for i in range(n):
+        body = ['entry:\n',
+                '  %%x = mul nsw i32 %%a, %%b, !taffo.info %s\n' % m.val]
+        if i + 1 < n:
+            body.append('  %%y = call i32 @chain%d(i32 %%x, i32 %%b), !taffo.info %s\n'
+                        % (i + 1, m.val))
+        else:
+            body.append('  %%y = add nsw i32 %%x, %%b, !taffo.info %s\n' % m.val)
+        tgt = ', !taffo.target %s' % m.target('chain') if i == 0 else ''
+        body.append('  %%r = add nsw i32 %%y, %%a, !taffo.info %s%s\n' % (m.val, tgt))
+        body.append('  ret i32 %r\n')
+        m.define('chain%d' % i, body, root=(i == 0))
+
+
+def gen_fanout(m, n, args):
+    for i in range(n):
+        m.define('leaf%d' % i, [
+            'entry:\n',
+            '  %%x = mul nsw i32 %%a, %%b, !taffo.info %s\n' % m.val,
+            '  %%r = add nsw i32 %%x, %%a, !taffo.info %s\n' % m.val,
+            '  ret i32 %r\n'])
+    body = ['entry:\n']
+    acc = '%a'
+    for i in range(n):
+        body.append('  %%c%d = call i32 @leaf%d(i32 %%a, i32 %%b), !taffo.info %s\n'
+                    % (i, i, m.val))
+        body.append('  %%s%d = add nsw i32 %s, %%c%d, !taffo.info %s\n' % (i, acc, i, m.val))
+        acc = '%%s%d' % i
+    body.append('  %%r = add nsw i32 %s, %%b, !taffo.info %s, !taffo.target %s\n'
+                % (acc, m.val, m.target('fanout')))
+    body.append('  ret i32 %r\n')
+    m.define('fanout', body, root=True)
+
+
+def gen_loops(m, n, args):
+    # Rotated loops in LCSSA form with dedicated exits,
+    # as produced by loop-simplify, loop-rotate and lcssa.
+    trip = args.trip
+    latch = lambda k: 'l%d' % k if k == n - 1 else 'l%d.latch' % k
+    exit = lambda k: 'exit' if k == 0 else 'l%d.latch' % (k - 1)
+    body = ['entry:\n', '  br label %l0\n']
+    for k in range(n):
+        init, pred = ('%a', 'entry') if k == 0 else ('%%acc%d' % (k - 1), 'l%d' % (k - 1))
+        body.append('l%d:\n' % k)
+        body.append('  %%acc%d = phi i32 [ %s, %%%s ], [ %%acc%d.next, %%%s ]\n'
+                    % (k, init, pred, k, latch(k)))
+        body.append('  %%i%d = phi i32 [ 0, %%%s ], [ %%i%d.next, %%%s ]\n'
+                    % (k, pred, k, latch(k)))
+        if k + 1 < n:
+            body.append('  br label %%l%d\n' % (k + 1))
+    for k in reversed(range(n)):
+        if k + 1 < n:
+            body.append('l%d.latch:\n' % k)
+            body.append('  %%acc%d.lcssa = phi i32 [ %%acc%d.next, %%%s ]\n'
+                        % (k + 1, k + 1, latch(k + 1)))
+            src = '%%acc%d.lcssa' % (k + 1)
+        else:
+            body.append('  %%t%d = mul nsw i32 %%acc%d, %%b, !taffo.info %s\n' % (k, k, m.val))
+            src = '%%t%d' % k
+        body.append('  %%acc%d.next = add nsw i32 %s, %%a, !taffo.info %s\n' % (k, src, m.val))
+        body.append('  %%i%d.next = add nuw nsw i32 %%i%d, 1\n' % (k, k))
+        body.append('  %%c%d = icmp ne i32 %%i%d.next, %d\n' % (k, k, trip))
+        body.append('  br i1 %%c%d, label %%l%d, label %%%s\n' % (k, k, exit(k)))
+    body.append('exit:\n')
+    body.append('  %%acc0.lcssa = phi i32 [ %%acc0.next, %%%s ]\n' % latch(0))
+    body.append('  %%r = add nsw i32 %%acc0.lcssa, %%b, !taffo.info %s, !taffo.target %s\n'
+                % (m.val, m.target('loops')))
+    body.append('  ret i32 %r\n')
+    m.define('loops', body, root=True)
+
+
+def gen_struct(m, n, args):
+    width = args.width
+    for k in range(n):
+        fields = ['i32'] * width
+        if k + 1 < n:
+            fields.append('%%struct.s%d' % (k + 1))
+        m.types.append('%%struct.s%d = type { %s }\n' % (k, ', '.join(fields)))
+    info = None
+    for k in reversed(range(n)):
+        fields = [m.val] * width + ([info] if info is not None else [])
+        info = m.node('!{%s}' % ', '.join(fields))
+
+    # Pointers to each nested struct.
+    ptr = lambda k: '%s' if k == 0 else '%%p%d' % k
+
+    def nested(body):
+        for k in range(1, n):
+            body.append('  %%p%d = getelementptr inbounds %%struct.s%d, %%struct.s%d* %s, i32 0, i32 %d\n'
+                        % (k, k - 1, k - 1, ptr(k - 1), width))
+
+    def field(body, k, j):
+        body.append('  %%f%d.%d = getelementptr inbounds %%struct.s%d, %%struct.s%d* %s, i32 0, i32 %d\n'
+                    % (k, j, k, k, ptr(k), j))
+        return '%%f%d.%d' % (k, j)
+
+    body = ['entry:\n']
+    nested(body)
+    acc = '0'
+    for k in range(n):
+        for j in range(width):
+            f = field(body, k, j)
+            body.append('  %%l%d.%d = load i32, i32* %s, align 4, !taffo.info %s\n' % (k, j, f, m.val))
+            body.append('  %%a%d.%d = add nsw i32 %s, %%l%d.%d, !taffo.info %s\n' % (k, j, acc, k, j, m.val))
+            acc = '%%a%d.%d' % (k, j)
+    body.append('  ret i32 %s\n' % acc)
+    m.define('structsum', body, params='%struct.s0* %s', args=[None])
+
+    body = ['entry:\n',
+            '  %%s = alloca %%struct.s0, align 8, !taffo.structinfo %s\n' % info]
+    nested(body)
+    for k in range(n):
+        for j in range(width):
+            f = field(body, k, j)
+            body.append('  %%v%d.%d = mul nsw i32 %%a, %%b, !taffo.info %s\n' % (k, j, m.val))
+            body.append('  store i32 %%v%d.%d, i32* %s, align 4\n' % (k, j, f))
+    body.append('  %%c = call i32 @structsum(%%struct.s0* %%s), !taffo.info %s\n' % m.val)
+    body.append('  %%r = add nsw i32 %%c, %%a, !taffo.info %s, !taffo.target %s\n'
+                % (m.val, m.target('struct')))
+    body.append('  ret i32 %r\n')
+    m.define('structs', body, root=True)
+
+
+def gen_depchain(m, n, args):
+    body = ['entry:\n']
+    prev = '%a'
+    for i in range(n):
+        if i % 2 == 0:
+            body.append('  %%x%d = mul nsw i32 %s, %%b, !taffo.info %s\n' % (i, prev, m.val))
+        else:
+            body.append('  %%x%d = add nsw i32 %s, %%a, !taffo.info %s\n' % (i, prev, m.val))
+        prev = '%%x%d' % i
+    body.append('  %%r = add nsw i32 %s, %%b, !taffo.info %s, !taffo.target %s\n'
+                % (prev, m.val, m.target('depchain')))
+    body.append('  ret i32 %r\n')
+    m.define('depchain', body, root=True)
+
+
+def gen_targets(m, n, args):
+    body = ['entry:\n']
+    acc = '%a'
+    for i in range(n):
+        body.append('  %%t%d = mul nsw i32 %%a, %%b, !taffo.info %s\n' % (i, m.val))
+        body.append('  %%u%d = add nsw i32 %%t%d, %%a, !taffo.info %s, !taffo.target %s\n'
+                    % (i, i, m.val, m.target('t%d' % i)))
+        body.append('  %%s%d = add nsw i32 %s, %%u%d, !taffo.info %s\n' % (i, acc, i, m.val))
+        acc = '%%s%d' % i
+    body.append('  ret i32 %s\n' % acc)
+    m.define('targets', body, root=True)
+
+
+def generate(kind, size, trip=16, width=8):
+    """Return the text of the stress case kind of the given size."""
+    args = argparse.Namespace(trip=trip, width=width)
+    m = Module()
+    globals()['gen_' + kind](m, max(1, size), args)
+    return m.text()
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Generate error propagator stress cases.')
+    parser.add_argument('kind', choices=KINDS)
+    parser.add_argument('size', type=int)
+    parser.add_argument('--trip', type=int, default=16,
+                        help='iterations of each loop (loops)')
+    parser.add_argument('--width', type=int, default=8,
+                        help='scalar fields of each struct (struct)')
+    parser.add_argument('-o', dest='output', default='-', help='output file')
+    args = parser.parse_args()
+
+    text = generate(args.kind, args.size, args.trip, args.width)
+    if args.output == '-':
+        sys.stdout.write(text)
+    else:
+        with open(args.output, 'w') as f:
+            f.write(text)
+
+
+if __name__ == '__main__':
+    main()
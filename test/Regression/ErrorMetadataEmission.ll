@@ -0,0 +1,36 @@
+; RUN: opt -load %errorproplib -errorprop -errmddigits=1 -S %s | FileCheck %s --check-prefix=DIGITS
+; RUN: opt -load %errorproplib -errorprop -errmdthresh=2.45e-5 -S %s | FileCheck %s --check-prefix=THRESH
+; RUN: opt -load %errorproplib -errorprop -errmd=none -S %s | FileCheck %s --check-prefix=NONE
+; RUN: opt -load %errorproplib -errorprop -errmdsize -S %s -o /dev/null 2>&1 | FileCheck %s --check-prefix=SIZE
+; RUN: opt -load %errorproplib -errorprop -S %s -o /dev/null 2>&1 | FileCheck %s --check-prefix=NOSIZE
+
+target datalayout = "e-m:e-i64:64-f80:128-n8:16:32:64-S128"
+target triple = "x86_64-unknown-linux-gnu"
+
+; DIGITS: %s = fadd double %a, %a, !taffo.abserror ![[E:[0-9]+]]
+; DIGITS: %t = fadd double %a, %b, !taffo.abserror ![[E]]
+; DIGITS: ret double %t, !taffo.abserror ![[E]]
+; DIGITS: ![[E]] = !{double 3.000000e-05}
+
+; SIZE: Bitcode size: {{[0-9]+}} bytes before, {{[0-9]+}} bytes after error metadata
+; NOSIZE-NOT: Bitcode size
+; NOSIZE-NOT: Error metadata attached
+
+; THRESH: %s = fadd double %a, %a{{$}}
+; THRESH: %t = fadd double %a, %b, !taffo.abserror
+
+; NONE-NOT: !taffo.abserror
+
+define double @foo(double %a, double %b) !taffo.funinfo !0 {
+entry:
+  %s = fadd double %a, %a
+  %t = fadd double %a, %b
+  ret double %t
+}
+
+!0 = !{i32 1, !1, i32 1, !4}
+!1 = !{i1 0, !2, !3}
+!2 = !{double 1.000000e+00, double 2.000000e+00}
+!3 = !{double 1.200000e-05}
+!4 = !{i1 0, !2, !5}
+!5 = !{double 1.300000e-05}
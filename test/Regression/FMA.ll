@@ -0,0 +1,61 @@
+; RUN: opt -load %errorproplib -errorprop -S %s | FileCheck %s
+
+target datalayout = "e-m:e-i64:64-f80:128-n8:16:32:64-S128"
+target triple = "x86_64-unknown-linux-gnu"
+
+; CHECK: %fma = call double @llvm.fma.f64(double %a, double %b, double %c), !taffo.abserror ![[E:[0-9]+]]
+; CHECK: %fmuladd = call double @llvm.fmuladd.f64(double %a, double %b, double %c), !taffo.abserror ![[E]]
+; CHECK: %libfma = call double @fma(double %a, double %b, double %c), !taffo.abserror ![[E]]
+; CHECK: %vfma = call <2 x double> @llvm.fma.v2f64(<2 x double> %vb, <2 x double> %vb, <2 x double> %vb), !taffo.abserror !{{[0-9]+}}
+; CHECK: %fmat = call double @llvm.fma.f64(double %a, double %b, double %c), !taffo.info !{{[0-9]+}}, !taffo.abserror ![[EF:[0-9]+]]
+; CHECK: %fmuladdt = call double @llvm.fmuladd.f64(double %a, double %b, double %c), !taffo.info !{{[0-9]+}}, !taffo.abserror ![[EU:[0-9]+]]
+; CHECK: %fmac = call double @llvm.fma.f64(double %a, double %b, double %ca), !taffo.abserror ![[EC:[0-9]+]]
+; CHECK: %invfma = invoke double @fma(double %a, double %b, double %c)
+; CHECK-NEXT: to label %cont unwind label %lpad, !taffo.abserror ![[E]]
+
+define double @foo(double %a, double %b, double %c) #0 personality i32 (...)* @__gxx_personality_v0 !taffo.funinfo !0 {
+entry:
+  %fma = call double @llvm.fma.f64(double %a, double %b, double %c)
+  %fmuladd = call double @llvm.fmuladd.f64(double %a, double %b, double %c)
+  %libfma = call double @fma(double %a, double %b, double %c)
+  %va = insertelement <2 x double> undef, double %a, i32 0
+  %vb = insertelement <2 x double> %va, double %b, i32 1
+  %vfma = call <2 x double> @llvm.fma.v2f64(<2 x double> %vb, <2 x double> %vb, <2 x double> %vb)
+  %fmat = call double @llvm.fma.f64(double %a, double %b, double %c), !taffo.info !4
+  %fmuladdt = call double @llvm.fmuladd.f64(double %a, double %b, double %c), !taffo.info !4
+  %ca = fsub double %c, %a
+  %fmac = call double @llvm.fma.f64(double %a, double %b, double %ca)
+  %invfma = invoke double @fma(double %a, double %b, double %c)
+	      to label %cont unwind label %lpad
+
+cont:
+  ret double %fma
+
+lpad:
+  %lp = landingpad { i8*, i32 }
+	  cleanup
+  resume { i8*, i32 } %lp
+}
+
+declare double @llvm.fma.f64(double, double, double)
+declare double @llvm.fmuladd.f64(double, double, double)
+declare double @fma(double, double, double)
+declare <2 x double> @llvm.fma.v2f64(<2 x double>, <2 x double>, <2 x double>)
+declare i32 @__gxx_personality_v0(...)
+
+!0 = !{i32 1, !1, i32 1, !1, i32 1, !1}
+!1 = !{i1 0, !2, !3}
+!2 = !{double 1.000000e+00, double 2.000000e+00}
+!3 = !{double 1.000000e-05}
+!4 = !{!5, !6, i1 0}
+!5 = !{!"fixp", i32 -32, i32 16}
+!6 = !{double 2.000000e+00, double 6.000000e+00}
+
+; a * b + c with errors of 1e-5 on [1, 2]: 1.5e-5 + 0.5e-5 for each factor,
+; 1e-10 for the product of their errors, and 1e-5 for the addend.
+; CHECK: ![[E]] = !{double 0x3F0A36E65AB83E{{[0-9A-F][0-9A-F]}}}
+; Plus one rounding error of 2^-16, or two for fmuladd.
+; CHECK: ![[EF]] = !{double 0x3F111B732D5C1F{{[0-9A-F][0-9A-F]}}}
+; CHECK: ![[EU]] = !{double 0x3F151B732D5C1F{{[0-9A-F][0-9A-F]}}}
+; The error of %a in the product (1.5e-5) and in %c - %a (-1e-5) partially cancel.
+; CHECK: ![[EC]] = !{double 0x3F04F8B8F87F64{{[0-9A-F][0-9A-F]}}}
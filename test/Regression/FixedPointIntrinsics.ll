@@ -0,0 +1,68 @@
+; RUN: opt -load %errorproplib -errorprop -S %s | FileCheck %s
+
+target datalayout = "e-m:e-i64:64-f80:128-n8:16:32:64-S128"
+target triple = "x86_64-unknown-linux-gnu"
+
+; CHECK: %add = call i32 @llvm.sadd.sat.i32(i32 %a, i32 %b), !taffo.abserror ![[E2:[0-9]+]]
+; CHECK: %sub = call i32 @llvm.ssub.sat.i32(i32 %a, i32 %b), !taffo.abserror ![[E2]]
+; CHECK: %mul = call i32 @llvm.smul.fix.i32(i32 %a, i32 %b, i32 16), !taffo.abserror ![[EM:[0-9]+]]
+; CHECK: %muls = call i32 @llvm.smul.fix.sat.i32(i32 %a, i32 %b, i32 16), !taffo.abserror ![[EM]]
+; CHECK: %div = call i32 @llvm.sdiv.fix.i32(i32 %a, i32 %b, i32 16), !taffo.abserror !{{[0-9]+}}
+; CHECK: %addsat = call i32 @llvm.sadd.sat.i32(i32 %a, i32 %b), !taffo.info !{{[0-9]+}}, !taffo.abserror ![[ES:[0-9]+]]
+; CHECK: %mixm = call i32 @llvm.smul.fix.i32(i32 %a, i32 %c, i32 16), !taffo.abserror ![[EMIX:[0-9]+]]
+; CHECK: %mixr = call i32 @llvm.smul.fix.i32(i32 %a, i32 %c, i32 8), !taffo.info !{{[0-9]+}}, !taffo.abserror ![[EM]]
+; CHECK: %dsat = call i32 @llvm.sadd.sat.i32(i32 %d, i32 %d), !taffo.abserror ![[EDSAT:[0-9]+]]
+; CHECK: %msat = call i32 @llvm.smul.fix.sat.i32(i32 %d, i32 %c, i32 0), !taffo.abserror ![[EMSAT:[0-9]+]]
+
+define i32 @foo(i32 %a, i32 %b, i32 %c, i32 %d) #0 !taffo.funinfo !0 {
+entry:
+  %add = call i32 @llvm.sadd.sat.i32(i32 %a, i32 %b)
+  %sub = call i32 @llvm.ssub.sat.i32(i32 %a, i32 %b)
+  %mul = call i32 @llvm.smul.fix.i32(i32 %a, i32 %b, i32 16)
+  %muls = call i32 @llvm.smul.fix.sat.i32(i32 %a, i32 %b, i32 16)
+  %div = call i32 @llvm.sdiv.fix.i32(i32 %a, i32 %b, i32 16)
+  %addsat = call i32 @llvm.sadd.sat.i32(i32 %a, i32 %b), !taffo.info !5
+  %mixm = call i32 @llvm.smul.fix.i32(i32 %a, i32 %c, i32 16)
+  %mixr = call i32 @llvm.smul.fix.i32(i32 %a, i32 %c, i32 8), !taffo.info !12
+  %dsat = call i32 @llvm.sadd.sat.i32(i32 %d, i32 %d)
+  %msat = call i32 @llvm.smul.fix.sat.i32(i32 %d, i32 %c, i32 0)
+  ret i32 %mul
+}
+
+declare i32 @llvm.sadd.sat.i32(i32, i32)
+declare i32 @llvm.ssub.sat.i32(i32, i32)
+declare i32 @llvm.smul.fix.i32(i32, i32, i32)
+declare i32 @llvm.smul.fix.sat.i32(i32, i32, i32)
+declare i32 @llvm.sdiv.fix.i32(i32, i32, i32)
+
+!0 = !{i32 1, !1, i32 1, !1, i32 1, !7, i32 1, !9}
+!1 = !{!2, !3, !4}
+!2 = !{!"fixp", i32 -32, i32 16}
+!3 = !{double 1.000000e+00, double 2.000000e+00}
+!4 = !{double 1.000000e-05}
+!5 = !{!2, !6, i1 0}
+; The largest representable value is 2^15 - 2^-16: up to 1 is clipped.
+!6 = !{double 2.000000e+00, double 32768.9999847412109375}
+; %c has 8 fractional bits.
+!7 = !{!8, !3, !4}
+!8 = !{!"fixp", i32 -32, i32 8}
+; %d is exact, and %d + %d may exceed 2^15 - 2^-16.
+!9 = !{!2, !10, !11}
+!10 = !{double 1.638400e+04, double 3.276700e+04}
+!11 = !{double 0.000000e+00}
+!12 = !{!2, !13, i1 0}
+!13 = !{double 1.000000e+00, double 4.000000e+00}
+
+; Multiplications of 1e-5 errors on [1, 2] give 4.00001e-5,
+; plus the truncation to the 16 fractional bits of the result (2^-16),
+; or to 16 + 8 - 16 = 8 bits when %c has 8 fractional bits.
+; Saturating additions and multiplications without range metadata
+; are clipped according to the ranges of their operands:
+; %d + %d <= 65534 is clipped to 2^15 - 2^-16, and %d * %c <= 65534
+; to 2^7 - 2^-24, as the result has 16 + 8 - 0 = 24 fractional bits.
+; CHECK: ![[E2]] = !{double 2.000000e-05}
+; CHECK: ![[EM]] = !{double 0x3F0CF8B8F87F64{{[0-9A-F][0-9A-F]}}}
+; CHECK: ![[ES]] = !{double 1.000020e+00}
+; CHECK: ![[EMIX]] = !{double 0x3F7029F171F0FE{{[0-9A-F][0-9A-F]}}}
+; CHECK: ![[EDSAT]] = !{double 0x40DFFF8000400000}
+; CHECK: ![[EMSAT]] = !{double 0x40EFEFCA7C460B{{[0-9A-F][0-9A-F]}}}
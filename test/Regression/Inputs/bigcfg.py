@@ -0,0 +1,52 @@
+#!/usr/bin/env python3
+# Generate a function with a very large CFG, made of a chain of diamonds.
+# Usage: bigcfg.py <number of basic blocks>
+import sys
+
+HEADER = """target datalayout = "e-m:e-i64:64-f80:128-n8:16:32:64-S128"
+target triple = "x86_64-unknown-linux-gnu"
+
+define i32 @foo(i32 %a, i32 %b) !taffo.funinfo !0 {
+entry:
+  %c = icmp slt i32 %a, %b
+  br label %s0
+"""
+
+FOOTER = """
+!0 = !{i32 1, !1, i32 1, !5}
+!1 = !{!2, !3, !4}
+!2 = !{!"fixp", i32 -32, i32 6}
+!3 = !{double -5.000000e+00, double 5.000000e+00}
+!4 = !{double 1.000000e-02}
+!5 = !{!2, !6, !4}
+!6 = !{double -6.000000e+00, double 6.000000e+00}
+"""
+
+
+def main():
+    nblocks = int(sys.argv[1]) if len(sys.argv) > 1 else 100000
+    nstages = max(1, (nblocks + 1) // 4)
+    out = [HEADER]
+    prev = '%a'
+    for k in range(nstages):
+        out.append('s%d:\n' % k)
+        out.append('  br i1 %%c, label %%l%d, label %%r%d\n' % (k, k))
+        out.append('l%d:\n' % k)
+        out.append('  %%xl%d = add nsw i32 %s, %%b\n' % (k, prev))
+        out.append('  br label %%m%d\n' % k)
+        out.append('r%d:\n' % k)
+        out.append('  %%xr%d = sub nsw i32 %s, %%b\n' % (k, prev))
+        out.append('  br label %%m%d\n' % k)
+        out.append('m%d:\n' % k)
+        out.append('  %%x%d = phi i32 [ %%xl%d, %%l%d ], [ %%xr%d, %%r%d ]\n' % (k, k, k, k, k))
+        out.append('  br label %%s%d\n' % (k + 1))
+        prev = '%%x%d' % k
+    out.append('s%d:\n' % nstages)
+    out.append('  ret i32 %s\n' % prev)
+    out.append('}\n')
+    out.append(FOOTER)
+    sys.stdout.write(''.join(out))
+
+
+if __name__ == '__main__':
+    main()
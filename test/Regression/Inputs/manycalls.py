@@ -0,0 +1,56 @@
+#!/usr/bin/env python3
+# Generate a function with many calls taking a pointer argument,
+# each through its own getelementptr of the same local variable.
+# Usage: manycalls.py <number of calls>
+import sys
+
+HEADER = """target datalayout = "e-m:e-i64:64-f80:128-n8:16:32:64-S128"
+target triple = "x86_64-unknown-linux-gnu"
+
+define i32 @scale(i32* %p, i32 %b) !taffo.funinfo !9 {
+entry:
+  %v = load i32, i32* %p, align 4
+  store i32 %b, i32* %p, align 4
+  %r = add nsw i32 %b, %b, !taffo.info !7
+  ret i32 %r
+}
+
+define i32 @foo(i32 %a, i32 %b) !taffo.funinfo !0 {
+entry:
+  %p = alloca [4 x i32], align 4
+  %p0 = getelementptr inbounds [4 x i32], [4 x i32]* %p, i64 0, i64 0
+  store i32 %a, i32* %p0, align 4
+"""
+
+FOOTER = """
+!0 = !{i32 1, !1, i32 1, !5}
+!1 = !{!2, !3, !4}
+!2 = !{!"fixp", i32 -32, i32 6}
+!3 = !{double -5.000000e+00, double 5.000000e+00}
+!4 = !{double 1.000000e-02}
+!5 = !{!2, !6, !4}
+!6 = !{double -6.000000e+00, double 6.000000e+00}
+!7 = !{!2, !8, i1 0}
+!8 = !{double -1.200000e+01, double 1.200000e+01}
+!9 = !{i32 0, i32 0, i32 1, !5}
+"""
+
+
+def main():
+    ncalls = int(sys.argv[1]) if len(sys.argv) > 1 else 2000
+    out = [HEADER]
+    acc = '%a'
+    for k in range(ncalls):
+        out.append('  %%g%d = getelementptr inbounds [4 x i32], [4 x i32]* %%p, i64 0, i64 %d\n'
+                   % (k, k % 4))
+        out.append('  %%c%d = call i32 @scale(i32* %%g%d, i32 %%b), !taffo.info !7\n' % (k, k))
+        out.append('  %%s%d = add nsw i32 %s, %%c%d\n' % (k, acc, k))
+        acc = '%%s%d' % k
+    out.append('  ret i32 %s\n' % acc)
+    out.append('}\n')
+    out.append(FOOTER)
+    sys.stdout.write(''.join(out))
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,12 @@
+target datalayout = "e-m:e-i64:64-f80:128-n8:16:32:64-S128"
+target triple = "x86_64-unknown-linux-gnu"
+
+define double @lib_twice(double %x) #0 !taffo.funinfo !0 {
+entry:
+  %r = fadd double %x, %x
+  ret double %r
+}
+
+!0 = !{i32 1, !1}
+!1 = !{i1 0, !2, i1 0}
+!2 = !{double 0.000000e+00, double 4.000000e+00}
@@ -0,0 +1,58 @@
+; RUN: opt %s -o %t.bc
+; RUN: opt -load %errorproplib -errorprop -emitsummaries=%t.yaml -S %S/Inputs/summarylib.ll > /dev/null
+; RUN: %errpropdriver -startfn=foo -summaries=%t.yaml %t.bc -S -o - | FileCheck %s
+; RUN: %errpropdriver -startfn=foo -summaries=%t.yaml -analyzedonly %t.bc -S -o - | FileCheck %s --check-prefix=ONLY
+
+target datalayout = "e-m:e-i64:64-f80:128-n8:16:32:64-S128"
+target triple = "x86_64-unknown-linux-gnu"
+
+; CHECK-LABEL: define double @foo
+; CHECK: %call = call double @twice(double %a), !taffo.abserror ![[E:[0-9]+]]
+; CHECK: %lib = call double @lib_twice(double %a), !taffo.abserror
+; CHECK: %libc = call double @lib_twice(double %c), !taffo.abserror
+define double @foo(double %a, double %c) !taffo.funinfo !4 {
+entry:
+  %call = call double @twice(double %a)
+  %lib = call double @lib_twice(double %a)
+  %libc = call double @lib_twice(double %c)
+  ret double %call
+}
+
+; CHECK-LABEL: define double @twice
+define double @twice(double %x) {
+entry:
+  %add = fadd double %x, %x
+  ret double %add
+}
+
+; The summary of lib_twice covers [0, 4], so it is not loaded for the call
+; with %a, but it must be loaded and analyzed for the call with %c.
+; CHECK-LABEL: define double @lib_twice
+; CHECK: %r = fadd double %x, %x, !taffo.abserror
+; ONLY-LABEL: define double @lib_twice
+define double @lib_twice(double %x) {
+entry:
+  %r = fadd double %x, %x
+  ret double %r
+}
+
+; Not reachable from foo: never analyzed, but loaded to write the whole module,
+; unless only the analyzed functions are written.
+; CHECK-LABEL: define double @unused
+; CHECK: %add = fadd double %x, %x{{$}}
+; ONLY: declare double @unused(double)
+define double @unused(double %x) !taffo.funinfo !0 {
+entry:
+  %add = fadd double %x, %x
+  ret double %add
+}
+
+!0 = !{i32 1, !1}
+!1 = !{i1 0, !2, !3}
+!2 = !{double 1.000000e+00, double 2.000000e+00}
+!3 = !{double 1.000000e-05}
+!4 = !{i32 1, !1, i32 1, !5}
+!5 = !{i1 0, !6, !3}
+!6 = !{double 5.000000e+00, double 6.000000e+00}
+
+; CHECK: ![[E]] = !{double 2.000000e-05}
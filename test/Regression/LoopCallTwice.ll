@@ -0,0 +1,49 @@
+; RUN: opt -load %errorproplib -errorprop -S %s | FileCheck %s
+; RUN: opt -load %errorproplib -errorprop -clonecache=0 -S %s | FileCheck %s
+
+target datalayout = "e-m:e-i64:64-f80:128-n8:16:32:64-S128"
+target triple = "x86_64-unknown-linux-gnu"
+
+; The unrolled copy of @loop made for the first call is reused by the second one
+; (or made again with -clonecache=0), and both give the same error.
+; CHECK-LABEL: define i32 @foo
+; CHECK: %c1 = call i32 @loop(i32 %a), !taffo.info !{{[0-9]+}}, !taffo.abserror ![[E:[0-9]+]]
+; CHECK: %c2 = call i32 @loop(i32 %a), !taffo.info !{{[0-9]+}}, !taffo.abserror ![[E]]
+define i32 @foo(i32 %a) !taffo.funinfo !0 {
+entry:
+  %c1 = call i32 @loop(i32 %a), !taffo.info !7
+  %c2 = call i32 @loop(i32 %a), !taffo.info !7
+  %s = add nsw i32 %c1, %c2, !taffo.info !9
+  ret i32 %s
+}
+
+; CHECK-LABEL: define i32 @loop
+; CHECK: %add = add nsw i32 %x.addr, %x.addr, !taffo.info !{{[0-9]+}}, !taffo.abserror
+define i32 @loop(i32 %x) !taffo.funinfo !0 {
+entry:
+  br label %for.body
+
+for.body:
+  %x.addr = phi i32 [ %x, %entry ], [ %add, %for.body ]
+  %i = phi i32 [ 0, %entry ], [ %inc, %for.body ]
+  %add = add nsw i32 %x.addr, %x.addr, !taffo.info !5
+  %inc = add nuw nsw i32 %i, 1
+  %exitcond = icmp ne i32 %inc, 4
+  br i1 %exitcond, label %for.body, label %for.end
+
+for.end:
+  %res = phi i32 [ %add, %for.body ]
+  ret i32 %res
+}
+
+!0 = !{i32 1, !1}
+!1 = !{!2, !3, !4}
+!2 = !{!"fixp", i32 -32, i32 4}
+!3 = !{double 5.000000e+00, double 6.000000e+00}
+!4 = !{double 1.250000e-02}
+!5 = !{!2, !6, i1 0}
+!6 = !{double 1.000000e+01, double 9.600000e+01}
+!7 = !{!2, !8, i1 0}
+!8 = !{double 8.000000e+01, double 9.600000e+01}
+!9 = !{!2, !10, i1 0}
+!10 = !{double 1.600000e+02, double 1.920000e+02}
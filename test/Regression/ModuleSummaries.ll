@@ -0,0 +1,29 @@
+; RUN: opt -load %errorproplib -errorprop -embedsummaries -S %S/Inputs/summarylib.ll | FileCheck %s --check-prefix=MD
+; RUN: opt -load %errorproplib -errorprop -embedsummaries %S/Inputs/summarylib.ll -o %t.bc
+; RUN: opt -load %errorproplib -errorprop -summaries=%t.bc -S %s | FileCheck %s
+
+; MD: !taffo.errsummaries = !{![[S:[0-9]+]]}
+; MD: ![[S]] = !{!"lib_twice", double 0.000000e+00, ![[A:[0-9]+]], ![[K:[0-9]+]], ![[M:[0-9]+]]}
+; MD: ![[A]] = !{double 0.000000e+00, double 4.000000e+00}
+; MD: ![[K]] = !{double 2.000000e+00}
+; MD: ![[M]] = !{double 4.000000e-02}
+
+target datalayout = "e-m:e-i64:64-f80:128-n8:16:32:64-S128"
+target triple = "x86_64-unknown-linux-gnu"
+
+; CHECK: %call = call double @lib_twice(double %a), !taffo.abserror ![[E:[0-9]+]]
+
+define double @foo(double %a) #0 !taffo.funinfo !0 {
+entry:
+  %call = call double @lib_twice(double %a)
+  ret double %call
+}
+
+declare double @lib_twice(double)
+
+!0 = !{i32 1, !1}
+!1 = !{i1 0, !2, !3}
+!2 = !{double 1.000000e+00, double 2.000000e+00}
+!3 = !{double 1.000000e-05}
+
+; CHECK: ![[E]] = !{double 2.000000e-05}
@@ -0,0 +1,27 @@
+; RUN: opt -load %errorproplib -errorprop -errorprop-report=%t.jsonl -S %s > /dev/null
+; RUN: FileCheck %s < %t.jsonl
+; RUN: %python -c "import json, sys; [json.loads(l) for l in open(sys.argv[1])]" %t.jsonl
+
+target datalayout = "e-m:e-i64:64-f80:128-n8:16:32:64-S128"
+target triple = "x86_64-unknown-linux-gnu"
+
+; The range of %a contains the pole of tan at pi/2, so the error is infinite,
+; which is written as a string since JSON numbers cannot be infinite.
+; CHECK: {"error":"inf","kind":"target","name":"t"}
+; CHECK: {"error":"inf","instructions":2,"kind":"function","name":"foo"}
+; CHECK-NEXT: {"error":"inf","function":"foo","index":0,"kind":"instruction","opcode":"call"}
+; CHECK-NEXT: {"error":"inf","function":"foo","index":1,"kind":"instruction","opcode":"ret"}
+
+define double @foo(double %a) !taffo.funinfo !0 {
+entry:
+  %t = call double @tan(double %a), !taffo.target !4
+  ret double %t
+}
+
+declare double @tan(double)
+
+!0 = !{i32 1, !1}
+!1 = !{i1 0, !2, !3}
+!2 = !{double 1.000000e+00, double 2.000000e+00}
+!3 = !{double 1.000000e-05}
+!4 = !{!"t"}
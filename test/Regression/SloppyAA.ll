@@ -0,0 +1,53 @@
+; RUN: opt -load %errorproplib -errorprop -sloppyaa -S %s | FileCheck %s
+
+target datalayout = "e-m:e-i64:64-f80:128-n8:16:32:64-S128"
+target triple = "x86_64-unknown-linux-gnu"
+
+%struct.pair = type { i32, i32 }
+
+; Both stores write the same field of a single object through pointers
+; loaded from memory: the load right after them reads the last stored value,
+; while loads in other blocks take the larger error of the two.
+; CHECK: %x = add nsw i32 %a, %b, !taffo.info !{{[0-9]+}}, !taffo.abserror ![[ERR:[0-9]+]]
+; CHECK: %l = load i32, i32* %f3, align 4, !taffo.info !{{[0-9]+}}, !taffo.abserror ![[ERRA:[0-9]+]]
+; CHECK: %m = load i32, i32* %f4, align 4, !taffo.info !{{[0-9]+}}, !taffo.abserror ![[ERR]]
+
+define i32 @foo(i32 %a, i32 %b) !taffo.funinfo !0 {
+entry:
+  %s = alloca %struct.pair, align 4
+  %pp = alloca %struct.pair*, align 8
+  store %struct.pair* %s, %struct.pair** %pp, align 8
+  %x = add nsw i32 %a, %b, !taffo.info !7
+  %q1 = load %struct.pair*, %struct.pair** %pp, align 8
+  %f1 = getelementptr inbounds %struct.pair, %struct.pair* %q1, i32 0, i32 0
+  store i32 %x, i32* %f1, align 4
+  %q2 = load %struct.pair*, %struct.pair** %pp, align 8
+  %f2 = getelementptr inbounds %struct.pair, %struct.pair* %q2, i32 0, i32 0
+  store i32 %a, i32* %f2, align 4
+  %q3 = load %struct.pair*, %struct.pair** %pp, align 8
+  %f3 = getelementptr inbounds %struct.pair, %struct.pair* %q3, i32 0, i32 0
+  %l = load i32, i32* %f3, align 4, !taffo.info !7
+  br label %exit
+
+exit:
+  %q4 = load %struct.pair*, %struct.pair** %pp, align 8
+  %f4 = getelementptr inbounds %struct.pair, %struct.pair* %q4, i32 0, i32 0
+  %m = load i32, i32* %f4, align 4, !taffo.info !7
+  %r = add nsw i32 %l, %m, !taffo.info !9
+  ret i32 %r
+}
+
+!0 = !{i32 1, !1, i32 1, !5}
+!1 = !{!2, !3, !4}
+!2 = !{!"fixp", i32 -32, i32 6}
+!3 = !{double -5.000000e+00, double 5.000000e+00}
+!4 = !{double 1.000000e-02}
+!5 = !{!2, !6, !4}
+!6 = !{double -6.000000e+00, double 6.000000e+00}
+!7 = !{!2, !8, i1 0}
+!8 = !{double -1.100000e+01, double 1.100000e+01}
+!9 = !{!2, !10, i1 0}
+!10 = !{double -2.200000e+01, double 2.200000e+01}
+
+; CHECK-DAG: ![[ERR]] = !{double 2.000000e-02}
+; CHECK-DAG: ![[ERRA]] = !{double 1.000000e-02}
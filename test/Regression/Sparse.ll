@@ -0,0 +1,58 @@
+; RUN: opt -load %errorproplib -errorprop -startonly -S %s | FileCheck %s
+; RUN: opt -load %errorproplib -errorprop -startonly -sparse -S %s | FileCheck %s
+
+target datalayout = "e-m:e-i64:64-f80:128-n8:16:32:64-S128"
+target triple = "x86_64-unknown-linux-gnu"
+
+@g = global i32 3, align 4, !taffo.info !0
+
+; Seeds are the ranged argument %a, the global @g, the call with range metadata
+; and the call to @inner, which has a body;
+; %n has no range, so %m is not reached even though it has other metadata.
+; CHECK-LABEL: define i32 @foo
+; CHECK: %0 = load i32, i32* @g, align 4, !taffo.abserror !{{[0-9]+}}
+; CHECK: %c = call i32 @get(), !taffo.info !{{[0-9]+}}, !taffo.abserror !{{[0-9]+}}
+; CHECK: %s = add nsw i32 %c, %0, !taffo.info !{{[0-9]+}}, !taffo.abserror !{{[0-9]+}}
+; CHECK: %t = add nsw i32 %s, %a, !taffo.info !{{[0-9]+}}, !taffo.abserror !{{[0-9]+}}
+; CHECK: %m = mul nsw i32 %n, 3, !unrelated !{{[0-9]+}}{{$}}
+
+; @inner is only analyzed through its call, whose argument has no range.
+; CHECK-LABEL: define void @inner
+; CHECK: %w = add nsw i32 %v, %v, !taffo.info !{{[0-9]+}}, !taffo.target !{{[0-9]+}}, !taffo.abserror !{{[0-9]+}}
+
+define i32 @foo(i32 %a, i32 %n) !taffo.funinfo !3 !taffo.start !14 {
+entry:
+  %0 = load i32, i32* @g, align 4
+  %c = call i32 @get(), !taffo.info !5
+  %s = add nsw i32 %c, %0, !taffo.info !7
+  %t = add nsw i32 %s, %a, !taffo.info !9
+  %m = mul nsw i32 %n, 3, !unrelated !11
+  %r = add nsw i32 %t, %m
+  call void @inner(i32 %n)
+  ret i32 %r
+}
+
+define void @inner(i32 %x) {
+entry:
+  %v = call i32 @get(), !taffo.info !5
+  %w = add nsw i32 %v, %v, !taffo.info !7, !taffo.target !13
+  ret void
+}
+
+declare i32 @get()
+
+!0 = !{!1, !2, !12}
+!1 = !{!"fixp", i32 32, i32 5}
+!2 = !{double 2.000000e+00, double 4.000000e+00}
+!3 = !{i32 1, !4, i32 0, i32 0}
+!4 = !{!1, !2, !12}
+!5 = !{!1, !6, !12}
+!6 = !{double 1.000000e+00, double 2.000000e+00}
+!7 = !{!1, !8, i1 0}
+!8 = !{double 3.000000e+00, double 6.000000e+00}
+!9 = !{!1, !10, i1 0}
+!10 = !{double 5.000000e+00, double 1.000000e+01}
+!11 = !{!"unrelated"}
+!12 = !{double 1.000000e-02}
+!13 = !{!"w"}
+!14 = !{i1 true}
@@ -0,0 +1,40 @@
+; RUN: opt -load %errorproplib -errorprop -specialfn=my_sqrt=sqrt,my_atan2=atan2 -S %s | FileCheck %s
+; RUN: opt -load %errorproplib -errorprop -specialfn my_sqrt=sqrt -specialfn=my_atan2=atan2 -S %s | FileCheck %s
+; RUN: opt -load %errorproplib -errorprop -S %s | FileCheck %s --check-prefix=NOALIAS
+; RUN: opt -load %errorproplib -errorprop -specialfn=my_sqrt=nosuchfn -S %s -o /dev/null 2>&1 | FileCheck %s --check-prefix=WARN
+
+target datalayout = "e-m:e-i64:64-f80:128-n8:16:32:64-S128"
+target triple = "x86_64-unknown-linux-gnu"
+
+; Aliases get the error of the elementary function they stand for.
+; CHECK: %sqrt = call double @sqrt(double %a), !taffo.abserror ![[EH:[0-9]+]]
+; CHECK: %mysqrt = call double @my_sqrt(double %a), !taffo.abserror ![[EH]]
+; CHECK: %atan2 = call double @atan2(double %a, double %b), !taffo.abserror ![[E2:[0-9]+]]
+; CHECK: %myatan2 = call double @my_atan2(double %a, double %b), !taffo.abserror ![[E2]]
+
+; Without aliases, single-argument functions pass the error through.
+; NOALIAS: %mysqrt = call double @my_sqrt(double %a), !taffo.abserror ![[E:[0-9]+]]
+; NOALIAS: %myatan2 = call double @my_atan2(double %a, double %b){{$}}
+; NOALIAS: ![[E]] = !{double 1.000000e-05}
+
+; WARN: WARNING: ignoring -specialfn=my_sqrt=nosuchfn (unknown elementary function)
+
+define double @foo(double %a, double %b) !taffo.funinfo !0 {
+entry:
+  %sqrt = call double @sqrt(double %a)
+  %mysqrt = call double @my_sqrt(double %a)
+  %atan2 = call double @atan2(double %a, double %b)
+  %myatan2 = call double @my_atan2(double %a, double %b)
+  %s = fadd double %mysqrt, %myatan2
+  ret double %s
+}
+
+declare double @sqrt(double)
+declare double @my_sqrt(double)
+declare double @atan2(double, double)
+declare double @my_atan2(double, double)
+
+!0 = !{i32 1, !1, i32 1, !1}
+!1 = !{i1 0, !2, !3}
+!2 = !{double 1.000000e+00, double 2.000000e+00}
+!3 = !{double 1.000000e-05}
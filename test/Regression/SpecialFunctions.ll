@@ -0,0 +1,57 @@
+; RUN: opt -load %errorproplib -errorprop -S %s | FileCheck %s
+
+target datalayout = "e-m:e-i64:64-f80:128-n8:16:32:64-S128"
+target triple = "x86_64-unknown-linux-gnu"
+
+; CHECK: %sqrt = call double @sqrt(double %a), !taffo.abserror ![[EH:[0-9]+]]
+; CHECK: %sqrtf = call double @_ZSt4sqrtf(double %a), !taffo.abserror ![[EH]]
+; CHECK: %sqrtfixp = call double @sqrtf_fixp(double %a), !taffo.abserror ![[EH]]
+; CHECK: %log = call double @llvm.log.f64(double %a), !taffo.abserror ![[E:[0-9]+]]
+; CHECK: %cos = call double @cos(double %a), !taffo.abserror ![[E]]
+; CHECK: %atan = call double @atan(double %a), !taffo.abserror ![[EH]]
+; CHECK: %atan2 = call double @atan2(double %a, double %b), !taffo.abserror ![[E]]
+; CHECK: %atan2c = call double @atan2(double %a, double %c), !taffo.abserror ![[E32:[0-9]+]]
+; CHECK: %hypot = call double @hypot(double %a, double 0.000000e+00), !taffo.abserror ![[E]]
+; CHECK: %tan = call double @tan(double %a), !taffo.abserror ![[EINF:[0-9]+]]
+; CHECK: %unknown = call double @unknown(double %a), !taffo.abserror ![[E]]
+
+define double @foo(double %a, double %b, double %c) #0 !taffo.funinfo !0 {
+entry:
+  %sqrt = call double @sqrt(double %a)
+  %sqrtf = call double @_ZSt4sqrtf(double %a)
+  %sqrtfixp = call double @sqrtf_fixp(double %a)
+  %log = call double @llvm.log.f64(double %a)
+  %cos = call double @cos(double %a)
+  %atan = call double @atan(double %a)
+  %atan2 = call double @atan2(double %a, double %b)
+  %atan2c = call double @atan2(double %a, double %c)
+  %hypot = call double @hypot(double %a, double 0.000000e+00)
+  %tan = call double @tan(double %a)
+  %unknown = call double @unknown(double %a)
+  ret double %sqrt
+}
+
+declare double @sqrt(double)
+declare double @_ZSt4sqrtf(double)
+declare double @sqrtf_fixp(double)
+declare double @llvm.log.f64(double)
+declare double @cos(double)
+declare double @atan(double)
+declare double @atan2(double, double)
+declare double @hypot(double, double)
+declare double @tan(double)
+declare double @unknown(double)
+
+!0 = !{i32 1, !1, i32 1, !1, i32 1, !4}
+!1 = !{i1 0, !2, !3}
+!2 = !{double 1.000000e+00, double 2.000000e+00}
+!3 = !{double 1.000000e-05}
+!4 = !{i1 0, !5, !3}
+!5 = !{double -1.000000e+00, double 1.000000e+00}
+
+; CHECK: ![[EH]] = !{double 5.000000e-06}
+; CHECK: ![[E]] = !{double 1.000000e-05}
+; d/dx atan2(a, c) = -a / (a^2 + c^2) is largest at c = 0, inside the range.
+; CHECK: ![[E32]] = !{double 1.5{{[0-9]*}}e-05}
+; tan has a pole at pi/2, in the range of %a.
+; CHECK: ![[EINF]] = !{double 0x7FF0000000000000}
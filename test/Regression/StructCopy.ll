@@ -0,0 +1,49 @@
+; RUN: opt -load %errorproplib -errorprop -S %s | FileCheck %s
+
+; Each call works on its own copy of the error map: the struct fields it
+; writes are copied before being modified, so the map of the caller and
+; those seen by later calls keep the field errors of @g from metadata.
+
+target datalayout = "e-m:e-i64:64-f80:128-n8:16:32:64-S128"
+target triple = "x86_64-unknown-linux-gnu"
+
+%struct.S = type { i32, i32 }
+
+@g = common global %struct.S zeroinitializer, align 4, !taffo.structinfo !0
+
+; CHECK-LABEL: define void @writer
+define void @writer(i32 %x) !taffo.funinfo !5 {
+entry:
+; CHECK: store i32 %x, {{.*}}, !taffo.abserror ![[EW:[0-9]+]]
+  store i32 %x, i32* getelementptr inbounds (%struct.S, %struct.S* @g, i32 0, i32 0), align 4
+  ret void
+}
+
+; CHECK-LABEL: define i32 @reader
+define i32 @reader() {
+entry:
+; CHECK: %v = load i32, {{.*}}, !taffo.info !{{[0-9]+}}, !taffo.abserror ![[EG:[0-9]+]]
+  %v = load i32, i32* getelementptr inbounds (%struct.S, %struct.S* @g, i32 0, i32 0), align 4, !taffo.info !2
+  ret i32 %v
+}
+
+; CHECK-LABEL: define i32 @main
+define i32 @main(i32 %x) !taffo.funinfo !5 {
+entry:
+  call void @writer(i32 %x)
+  %r = call i32 @reader()
+  ret i32 %r
+}
+
+; CHECK-DAG: ![[EW]] = !{double 1.000000e-03}
+; CHECK-DAG: ![[EG]] = !{double 1.000000e-08}
+
+!0 = !{!1, !1}
+!1 = !{!3, !4, !7}
+!2 = !{!3, !4, i1 false}
+!3 = !{!"fixp", i32 -32, i32 20}
+!4 = !{double 0.000000e+00, double 1.000000e+02}
+!5 = !{i32 1, !6}
+!6 = !{!3, !4, !8}
+!7 = !{double 1.000000e-08}
+!8 = !{double 1.000000e-03}
@@ -0,0 +1,87 @@
+; RUN: opt -load %errorproplib -errorprop -S %s | FileCheck %s
+
+; Fields reached through a pointer to the enclosing struct type have
+; their own slots, and GEP indices are applied from the root to the field.
+; Loads follow an opaque call that may modify the structs, so their errors
+; come from the struct fields.
+
+target datalayout = "e-m:e-i64:64-f80:128-n8:16:32:64-S128"
+target triple = "x86_64-unknown-linux-gnu"
+
+%struct.node = type { i32, i32, %struct.node* }
+%struct.in = type { i32, i32 }
+%struct.pair = type { %struct.in, %struct.in }
+
+declare void @opaque(i8*)
+
+; CHECK-LABEL: define i32 @list
+define i32 @list(i32 %x, i32 %y) !taffo.funinfo !0 {
+entry:
+  %n = alloca %struct.node, align 8
+  %m = alloca %struct.node, align 8
+  %l = alloca %struct.node, align 8
+  %n.next = getelementptr inbounds %struct.node, %struct.node* %n, i32 0, i32 2
+  store %struct.node* %m, %struct.node** %n.next, align 8
+  %m.next = getelementptr inbounds %struct.node, %struct.node* %m, i32 0, i32 2
+  store %struct.node* %l, %struct.node** %m.next, align 8
+  %next = load %struct.node*, %struct.node** %n.next, align 8
+  %v.p = getelementptr inbounds %struct.node, %struct.node* %next, i32 0, i32 0
+; CHECK: store i32 %x, i32* %v.p, align 4, !taffo.abserror ![[EX:[0-9]+]]
+  store i32 %x, i32* %v.p, align 4
+  %w.p = getelementptr inbounds %struct.node, %struct.node* %next, i32 0, i32 1
+; CHECK: store i32 %y, i32* %w.p, align 4, !taffo.abserror ![[EY:[0-9]+]]
+  store i32 %y, i32* %w.p, align 4
+  %n.i8 = bitcast %struct.node* %n to i8*
+  call void @opaque(i8* %n.i8)
+  %next1 = load %struct.node*, %struct.node** %n.next, align 8
+  %v1.p = getelementptr inbounds %struct.node, %struct.node* %next1, i32 0, i32 0
+; CHECK: %v = load i32, i32* %v1.p, align 4, !taffo.info !{{[0-9]+}}, !taffo.abserror ![[EX]]
+  %v = load i32, i32* %v1.p, align 4, !taffo.info !4
+  %w1.p = getelementptr inbounds %struct.node, %struct.node* %next1, i32 0, i32 1
+; CHECK: %w = load i32, i32* %w1.p, align 4, !taffo.info !{{[0-9]+}}, !taffo.abserror ![[EY]]
+  %w = load i32, i32* %w1.p, align 4, !taffo.info !4
+  ; Deeper nodes share the slots of the first one.
+  %next.next = getelementptr inbounds %struct.node, %struct.node* %next1, i32 0, i32 2
+  %next2 = load %struct.node*, %struct.node** %next.next, align 8
+  %v2.p = getelementptr inbounds %struct.node, %struct.node* %next2, i32 0, i32 0
+; CHECK: %vv = load i32, i32* %v2.p, align 4, !taffo.info !{{[0-9]+}}, !taffo.abserror ![[EX]]
+  %vv = load i32, i32* %v2.p, align 4, !taffo.info !4
+  %s = add nsw i32 %v, %w, !taffo.info !4
+  %t = add nsw i32 %s, %vv, !taffo.info !4
+  ret i32 %t
+}
+
+; CHECK-LABEL: define i32 @pair
+define i32 @pair(i32 %x, i32 %y) !taffo.funinfo !0 {
+entry:
+  %q = alloca %struct.pair, align 4
+  %a0.p = getelementptr inbounds %struct.pair, %struct.pair* %q, i32 0, i32 1, i32 0
+; CHECK: store i32 %x, i32* %a0.p, align 4, !taffo.abserror ![[PX:[0-9]+]]
+  store i32 %x, i32* %a0.p, align 4
+  %b1.p = getelementptr inbounds %struct.pair, %struct.pair* %q, i32 0, i32 0, i32 1
+; CHECK: store i32 %y, i32* %b1.p, align 4, !taffo.abserror ![[PY:[0-9]+]]
+  store i32 %y, i32* %b1.p, align 4
+  %q.i8 = bitcast %struct.pair* %q to i8*
+  call void @opaque(i8* %q.i8)
+  %a = getelementptr inbounds %struct.pair, %struct.pair* %q, i32 0, i32 1
+  %a0 = getelementptr inbounds %struct.in, %struct.in* %a, i32 0, i32 0
+; CHECK: %u = load i32, i32* %a0, align 4, !taffo.info !{{[0-9]+}}, !taffo.abserror ![[PX]]
+  %u = load i32, i32* %a0, align 4, !taffo.info !4
+  %b1 = getelementptr inbounds %struct.pair, %struct.pair* %q, i32 0, i32 0, i32 1
+; CHECK: %z = load i32, i32* %b1, align 4, !taffo.info !{{[0-9]+}}, !taffo.abserror ![[PY]]
+  %z = load i32, i32* %b1, align 4, !taffo.info !4
+  %s = add nsw i32 %u, %z, !taffo.info !4
+  ret i32 %s
+}
+
+; CHECK-DAG: ![[EX]] = !{double 1.000000e-08}
+; CHECK-DAG: ![[EY]] = !{double 1.000000e-06}
+
+!0 = !{i32 1, !1, i32 1, !5}
+!1 = !{!2, !3, !6}
+!2 = !{!"fixp", i32 -32, i32 20}
+!3 = !{double 0.000000e+00, double 1.000000e+02}
+!4 = !{!2, !3, i1 false}
+!5 = !{!2, !3, !7}
+!6 = !{double 1.000000e-08}
+!7 = !{double 1.000000e-06}
@@ -0,0 +1,38 @@
+; RUN: opt -load %errorproplib -errorprop -emitsummaries=%t.yaml -S %S/Inputs/summarylib.ll > /dev/null
+; RUN: FileCheck %s --check-prefix=YAML < %t.yaml
+; RUN: opt -load %errorproplib -errorprop -summaries=%t.yaml -S %s | FileCheck %s
+
+; YAML: - name: lib_twice
+; YAML-NEXT: args:
+; YAML-NEXT: - { min: 0, max: 4, maxerror: 0.04 }
+; YAML-NEXT: sensitivity: [ 2 ]
+
+target datalayout = "e-m:e-i64:64-f80:128-n8:16:32:64-S128"
+target triple = "x86_64-unknown-linux-gnu"
+
+; The range of %b is unknown, so the summary does not cover the second call.
+; The error on %c is larger than maxerror, so the summary does not cover the third call.
+; CHECK: %call = call double @lib_twice(double %a), !taffo.abserror ![[E:[0-9]+]]
+; CHECK: %call1 = call double @lib_twice(double %b){{$}}
+; CHECK: %call2 = call double @lib_twice(double %c){{$}}
+
+define double @foo(double %a, double %b, double %c) #0 !taffo.funinfo !0 {
+entry:
+  %call = call double @lib_twice(double %a)
+  %call1 = call double @lib_twice(double %b)
+  %call2 = call double @lib_twice(double %c)
+  %add = fadd double %call, %call1
+  %add1 = fadd double %add, %call2
+  ret double %add1
+}
+
+declare double @lib_twice(double)
+
+!0 = !{i32 1, !1, i32 0, i32 0, i32 1, !4}
+!1 = !{i1 0, !2, !3}
+!2 = !{double 1.000000e+00, double 2.000000e+00}
+!3 = !{double 1.000000e-05}
+!4 = !{i1 0, !2, !5}
+!5 = !{double 1.000000e-01}
+
+; CHECK: ![[E]] = !{double 2.000000e-05}
@@ -0,0 +1,34 @@
+; RUN: opt -load %errorproplib -errorprop -emitsummaries=%t.yaml -S %s > /dev/null
+; RUN: FileCheck %s < %t.yaml
+
+; The select takes the largest error of its operands, so an error
+; on %x smaller than the rounding error of %z does not change the result.
+; The sensitivity to %x must not be 0 nonetheless: it bounds the error
+; for errors on %x up to maxerror = 0.01 * 4.
+
+; CHECK: - name: lib_join
+; CHECK-NEXT: args:
+; CHECK-NEXT: - { min: 0, max: 4, maxerror: 0.04 }
+; CHECK-NEXT: - { min: 0, max: 4, maxerror: 0.04 }
+; CHECK-NEXT: sensitivity: [ 0.993896, 1 ]
+; CHECK-NEXT: error: 0.000244141
+
+target datalayout = "e-m:e-i64:64-f80:128-n8:16:32:64-S128"
+target triple = "x86_64-unknown-linux-gnu"
+
+define i32 @lib_join(i32 %x, i32 %w) !taffo.funinfo !0 {
+entry:
+  %c = icmp slt i32 %x, %w
+  %z = sub i32 0, %w, !taffo.info !4
+  %r = select i1 %c, i32 %x, i32 %z, !taffo.info !6
+  ret i32 %r
+}
+
+!0 = !{i32 1, !1, i32 1, !1}
+!1 = !{!2, !3, i1 false}
+!2 = !{!"fixp", i32 -32, i32 12}
+!3 = !{double 0.000000e+00, double 4.000000e+00}
+!4 = !{!2, !5, i1 false}
+!5 = !{double -4.000000e+00, double 0.000000e+00}
+!6 = !{!2, !7, i1 false}
+!7 = !{double -4.000000e+00, double 4.000000e+00}
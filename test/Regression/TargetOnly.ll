@@ -0,0 +1,50 @@
+; RUN: opt -load %errorproplib -errorprop -targetonly -S %s | FileCheck %s
+
+target datalayout = "e-m:e-i64:64-f80:128-n8:16:32:64-S128"
+target triple = "x86_64-unknown-linux-gnu"
+
+; @bar computes a value on which the target depends, @baz does not.
+; CHECK-LABEL: define i32 @bar
+; CHECK: %sub = sub nsw i32 %a, %b, !taffo.info !{{[0-9]+}}, !taffo.abserror !{{[0-9]+}}
+; CHECK-LABEL: define i32 @baz
+; CHECK: %add = add nsw i32 %a, %b, !taffo.info !{{[0-9]+}}{{$}}
+; CHECK-LABEL: define i32 @foo
+; CHECK: %c = call i32 @bar(i32 %a, i32 %b), !taffo.info !{{[0-9]+}}, !taffo.abserror !{{[0-9]+}}
+; CHECK: %d = call i32 @baz(i32 %a, i32 %b), !taffo.info !{{[0-9]+}}{{$}}
+; CHECK: %t = add nsw i32 %c, %a, !taffo.info !{{[0-9]+}}, !taffo.target !{{[0-9]+}}, !taffo.abserror !{{[0-9]+}}
+; CHECK: %u = add nsw i32 %d, %b, !taffo.info !{{[0-9]+}}{{$}}
+
+define i32 @bar(i32 %a, i32 %b) !taffo.funinfo !0 {
+entry:
+  %sub = sub nsw i32 %a, %b, !taffo.info !7
+  ret i32 %sub
+}
+
+define i32 @baz(i32 %a, i32 %b) !taffo.funinfo !0 {
+entry:
+  %add = add nsw i32 %a, %b, !taffo.info !7
+  ret i32 %add
+}
+
+define i32 @foo(i32 %a, i32 %b) !taffo.funinfo !0 {
+entry:
+  %c = call i32 @bar(i32 %a, i32 %b), !taffo.info !7
+  %d = call i32 @baz(i32 %a, i32 %b), !taffo.info !7
+  %t = add nsw i32 %c, %a, !taffo.info !9, !taffo.target !11
+  %u = add nsw i32 %d, %b, !taffo.info !9
+  %r = add nsw i32 %t, %u, !taffo.info !9
+  ret i32 %r
+}
+
+!0 = !{i32 1, !1, i32 1, !5}
+!1 = !{!2, !3, !4}
+!2 = !{!"fixp", i32 -32, i32 6}
+!3 = !{double -5.000000e+00, double 5.000000e+00}
+!4 = !{double 1.000000e-02}
+!5 = !{!2, !6, !4}
+!6 = !{double -6.000000e+00, double 6.000000e+00}
+!7 = !{!2, !8, i1 0}
+!8 = !{double -1.100000e+01, double 1.100000e+01}
+!9 = !{!2, !10, i1 0}
+!10 = !{double -1.700000e+01, double 1.700000e+01}
+!11 = !{!"t"}
@@ -0,0 +1,38 @@
+; RUN: opt -load %errorproplib -errorprop -S %s | FileCheck %s
+
+target datalayout = "e-m:e-i64:64-f80:128-n8:16:32:64-S128"
+target triple = "x86_64-unknown-linux-gnu"
+
+; CHECK: %va0 = insertelement <2 x i64> undef, i64 %a, i32 0, !taffo.abserror ![[E1:[0-9]+]]
+; CHECK: %va = insertelement <2 x i64> %va0, i64 %b, i32 1, !taffo.abserror ![[E2:[0-9]+]]
+; CHECK: %vs = add <2 x i64> %va, %va, !taffo.abserror ![[E4:[0-9]+]]
+; CHECK: %e0 = extractelement <2 x i64> %vs, i32 0, !taffo.abserror ![[E2]]
+; CHECK: %sh = shufflevector <2 x i64> %vs, <2 x i64> undef, <2 x i32> <i32 1, i32 1>, !taffo.abserror ![[E4]]
+; CHECK: %e1 = extractelement <2 x i64> %sh, i32 0, !taffo.abserror ![[E4]]
+; CHECK: %r = call i64 @llvm.experimental.vector.reduce.add.v2i64(<2 x i64> %vs), !taffo.abserror !{{[0-9]+}}
+
+define i64 @foo(i64 %a, i64 %b) #0 !taffo.funinfo !0 {
+entry:
+  %va0 = insertelement <2 x i64> undef, i64 %a, i32 0
+  %va = insertelement <2 x i64> %va0, i64 %b, i32 1
+  %vs = add <2 x i64> %va, %va
+  %e0 = extractelement <2 x i64> %vs, i32 0
+  %sh = shufflevector <2 x i64> %vs, <2 x i64> undef, <2 x i32> <i32 1, i32 1>
+  %e1 = extractelement <2 x i64> %sh, i32 0
+  %r = call i64 @llvm.experimental.vector.reduce.add.v2i64(<2 x i64> %vs)
+  ret i64 %r
+}
+
+declare i64 @llvm.experimental.vector.reduce.add.v2i64(<2 x i64>)
+
+!0 = !{i32 1, !1, i32 1, !5}
+!1 = !{!2, !3, !4}
+!2 = !{!"fixp", i32 -64, i32 20}
+!3 = !{double 1.000000e+00, double 2.000000e+00}
+!4 = !{double 1.000000e-05}
+!5 = !{!2, !3, !6}
+!6 = !{double 2.000000e-05}
+
+; CHECK-DAG: ![[E1]] = !{double 1.000000e-05}
+; CHECK-DAG: ![[E2]] = !{double 2.000000e-05}
+; CHECK-DAG: ![[E4]] = !{double 4.000000e-05}